@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // Brightness rises well past 1 towards the right, with a bright spot in the middle.
+    float spot = 16.0 * exp(-64.0 * dot(fragTexCoord - 0.5, fragTexCoord - 0.5));
+    vec3 color = vec3(fragTexCoord.x, 0.5, 1.0 - fragTexCoord.y) * exp2(fragTexCoord.x * 6.0 - 2.0);
+    outColor = vec4(color + spot, 1.0);
+}
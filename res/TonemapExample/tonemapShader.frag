@@ -0,0 +1,17 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    float exposure;
+} ubo;
+
+layout(binding = 1) uniform sampler2D hdrSampler;
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec3 color = texture(hdrSampler, fragTexCoord).rgb * ubo.exposure;
+    // Reinhard tonemapping, the swapchain format applies the sRGB curve when it's written.
+    outColor = vec4(color / (color + 1.0), 1.0);
+}
@@ -0,0 +1,135 @@
+#include "../GpuVk/RenderEngine.hpp"
+
+/*
+ * Tonemap:
+ * Renders an HDR scene to an offscreen pass, then tonemaps it to the swapchain with a fullscreen triangle.
+ */
+
+using namespace GpuVk;
+
+struct UniformBufferData
+{
+    alignas(4) float Exposure;
+};
+
+class App : public IRenderer
+{
+    private:
+    Pipeline _scenePipeline;
+    Pipeline _tonemapPipeline;
+    RenderPass _hdrRenderPass;
+    RenderPass _renderPass;
+
+    ClearColor _clearColor;
+
+    Sampler _hdrSampler;
+
+    UniformBuffer<UniformBufferData> _ubo;
+    UniformBufferData _uboData;
+
+    float _time = 0.0f;
+
+    public:
+    void Init(std::shared_ptr<Gpu> gpu, SDL_Window* window, int32_t width, int32_t height)
+    {
+        _ubo = UniformBuffer<UniformBufferData>(gpu);
+
+        RenderPassOptions hdrRenderPassOptions{};
+        hdrRenderPassOptions.EnableDepth = false;
+        hdrRenderPassOptions.ColorAttachmentUsage = ColorAttachmentUsage::ReadFromShader;
+        hdrRenderPassOptions.ColorFormat = ImageFormat::B10G11R11UFloat;
+        _hdrRenderPass = RenderPass(gpu, hdrRenderPassOptions);
+        _hdrSampler = Sampler(gpu, _hdrRenderPass.GetColorImage());
+
+        RenderPassOptions renderPassOptions{};
+        renderPassOptions.EnableDepth = false;
+        renderPassOptions.ColorAttachmentUsage = ColorAttachmentUsage::Present;
+        _renderPass = RenderPass(gpu, renderPassOptions);
+
+        // Both passes draw a fullscreen triangle made from gl_VertexIndex, so neither pipeline has vertex data.
+        PipelineOptions scenePipelineOptions{};
+        scenePipelineOptions.VertexShader = "res/TonemapExample/fullscreenTriangle.vert.spv";
+        scenePipelineOptions.FragmentShader = "res/TonemapExample/hdrSceneShader.frag.spv";
+        scenePipelineOptions.EnableTransparency = false;
+        scenePipelineOptions.CullMode = CullFace::None;
+        scenePipelineOptions.EnableDepthTest = false;
+        scenePipelineOptions.EnableDepthWrite = false;
+        _scenePipeline = Pipeline(gpu, scenePipelineOptions, _hdrRenderPass);
+
+        PipelineOptions tonemapPipelineOptions{};
+        tonemapPipelineOptions.VertexShader = "res/TonemapExample/fullscreenTriangle.vert.spv";
+        tonemapPipelineOptions.FragmentShader = "res/TonemapExample/tonemapShader.frag.spv";
+        tonemapPipelineOptions.EnableTransparency = false;
+        tonemapPipelineOptions.CullMode = CullFace::None;
+        tonemapPipelineOptions.EnableDepthTest = false;
+        tonemapPipelineOptions.EnableDepthWrite = false;
+        tonemapPipelineOptions.DescriptorLayouts.push_back({
+            .Binding = 0,
+            .Type = DescriptorType::UniformBuffer,
+            .ShaderStage = ShaderStage::Fragment,
+        });
+        tonemapPipelineOptions.DescriptorLayouts.push_back({
+            .Binding = 1,
+            .Type = DescriptorType::ImageSampler,
+            .ShaderStage = ShaderStage::Fragment,
+        });
+        _tonemapPipeline = Pipeline(gpu, tonemapPipelineOptions, _renderPass);
+        _tonemapPipeline.UpdateUniform(0, _ubo);
+        _tonemapPipeline.UpdateImage(1, _hdrRenderPass.GetColorImage(), _hdrSampler);
+    }
+
+    void Update(std::shared_ptr<Gpu> gpu, float deltaTime)
+    {
+        _time += deltaTime;
+    }
+
+    void Render(std::shared_ptr<Gpu> gpu)
+    {
+        // Sweeps the exposure between a quarter and 4 times, to show detail in both the dark and bright parts.
+        _uboData.Exposure = std::exp2(2.0f * std::sin(_time * 0.5f));
+
+        _ubo.Update(_uboData);
+
+        gpu->Commands.BeginBuffer();
+
+        _clearColor = {0.0f, 0.0f, 0.0f};
+        _hdrRenderPass.Begin(_clearColor);
+        _scenePipeline.Bind();
+
+        _scenePipeline.Draw(3);
+
+        _hdrRenderPass.End();
+
+        _renderPass.Begin(_clearColor);
+        _tonemapPipeline.Bind();
+
+        _tonemapPipeline.Draw(3);
+
+        _renderPass.End();
+
+        gpu->Commands.EndBuffer();
+    }
+
+    void Resize(std::shared_ptr<Gpu> gpu, int32_t width, int32_t height)
+    {
+        _hdrRenderPass.UpdateResources();
+        _renderPass.UpdateResources();
+        _tonemapPipeline.UpdateImage(1, _hdrRenderPass.GetColorImage(), _hdrSampler);
+    }
+};
+
+int main()
+{
+    try
+    {
+        RenderEngine renderEngine;
+        renderEngine.Run("Tonemap", 640, 480, App());
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
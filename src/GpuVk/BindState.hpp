@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cinttypes>
+
+namespace GpuVk
+{
+const uint32_t MaxTrackedVertexBindings = 16;
+
+struct BindStats
+{
+    uint32_t Issued = 0;
+    uint32_t Skipped = 0;
+};
+
+// The state that has been bound to a single command buffer since it began recording.
+struct BindState
+{
+    struct PipelineBindings
+    {
+        VkPipeline Pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout Layout = VK_NULL_HANDLE;
+        VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+    };
+
+    // Indexed by bind point, graphics and compute.
+    std::array<PipelineBindings, 2> BindPoints{};
+    std::array<VkBuffer, MaxTrackedVertexBindings> VertexBuffers{};
+    VkBuffer IndexBuffer = VK_NULL_HANDLE;
+    VkIndexType IndexType = VK_INDEX_TYPE_UINT16;
+    BindStats Stats;
+};
+} // namespace GpuVk
\ No newline at end of file
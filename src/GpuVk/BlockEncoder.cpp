@@ -0,0 +1,353 @@
+#include "BlockEncoder.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+// Bounds and indices are found with SSE2 on x64, which always has it.
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GPUVK_SSE2
+#endif
+
+namespace GpuVk
+{
+bool BlockEncoder::IsFormatSupported(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::vector<uint8_t> BlockEncoder::Encode(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format)
+{
+    if (!IsFormatSupported(format))
+        throw std::runtime_error("Tried to block compress to an unsupported format!");
+
+    bool hasAlpha = format == VK_FORMAT_BC3_UNORM_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK;
+    std::vector<uint8_t> data(GetByteSize(format, width, height));
+    uint8_t* dst = data.data();
+
+    uint8_t block[64];
+    uint8_t minColor[4];
+    uint8_t maxColor[4];
+
+    for (uint32_t y = 0; y < height; y += 4)
+    {
+        for (uint32_t x = 0; x < width; x += 4)
+        {
+            LoadBlock(rgba, width, height, x, y, block);
+            FindBounds(block, minColor, maxColor);
+
+            // BC3 blocks start with the alpha, followed by the same color block as BC1.
+            if (hasAlpha)
+            {
+                EncodeAlphaBlock(block, minColor[3], maxColor[3], dst);
+                dst += 8;
+            }
+
+            EncodeColorBlock(block, minColor, maxColor, dst);
+            dst += 8;
+        }
+    }
+
+    return data;
+}
+
+size_t BlockEncoder::GetByteSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    if (!IsFormatSupported(format))
+        throw std::runtime_error("Tried to get the size of an unsupported block compressed format!");
+
+    bool hasAlpha = format == VK_FORMAT_BC3_UNORM_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK;
+    size_t blockCount = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+
+    return blockCount * (hasAlpha ? 16 : 8);
+}
+
+void BlockEncoder::LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y,
+    uint8_t* block)
+{
+    if (x + 4 <= width && y + 4 <= height)
+    {
+        for (uint32_t row = 0; row < 4; row++)
+            std::memcpy(block + row * 16, rgba + (static_cast<size_t>(y + row) * width + x) * 4, 16);
+
+        return;
+    }
+
+    for (uint32_t row = 0; row < 4; row++)
+    {
+        uint32_t sourceY = std::min(y + row, height - 1);
+
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            uint32_t sourceX = std::min(x + column, width - 1);
+            std::memcpy(block + (row * 4 + column) * 4, rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+        }
+    }
+}
+
+void BlockEncoder::EncodeColorBlock(const uint8_t* block, const uint8_t* minColor, const uint8_t* maxColor,
+    uint8_t* dst)
+{
+    int32_t low[3];
+    int32_t high[3];
+    int32_t center[3];
+    int32_t axis = 0;
+
+    // Insetting the box by a sixteenth of its size moves the endpoints towards where most colors are, since the
+    // extremes are usually outliers.
+    for (int32_t channel = 0; channel < 3; channel++)
+    {
+        int32_t inset = (maxColor[channel] - minColor[channel]) >> 4;
+        low[channel] = minColor[channel] + inset;
+        high[channel] = maxColor[channel] - inset;
+        center[channel] = (minColor[channel] + maxColor[channel] + 1) / 2;
+
+        if (high[channel] - low[channel] > high[axis] - low[axis])
+            axis = channel;
+    }
+
+    // The box has 4 diagonals, the colors lie along the one where the other channels rise or fall with the widest.
+    int32_t covariance[3] = {};
+
+    for (int32_t i = 0; i < 16; i++)
+    {
+        int32_t axisValue = block[i * 4 + axis] - center[axis];
+
+        for (int32_t channel = 0; channel < 3; channel++)
+            covariance[channel] += axisValue * (block[i * 4 + channel] - center[channel]);
+    }
+
+    for (int32_t channel = 0; channel < 3; channel++)
+    {
+        if (covariance[channel] < 0)
+            std::swap(low[channel], high[channel]);
+    }
+
+    uint8_t highColor[4] = {static_cast<uint8_t>(high[0]), static_cast<uint8_t>(high[1]),
+        static_cast<uint8_t>(high[2]), 0};
+    uint8_t lowColor[4] = {static_cast<uint8_t>(low[0]), static_cast<uint8_t>(low[1]), static_cast<uint8_t>(low[2]), 0};
+    uint16_t color0 = ToRgb565(highColor);
+    uint16_t color1 = ToRgb565(lowColor);
+
+    // The first endpoint has to be the larger one, otherwise the block uses 3 colors and transparent black.
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    uint8_t palette[4][4] = {};
+    FromRgb565(color0, palette[0]);
+    FromRgb565(color1, palette[1]);
+
+    for (int32_t channel = 0; channel < 3; channel++)
+    {
+        palette[2][channel] = static_cast<uint8_t>((2 * palette[0][channel] + palette[1][channel] + 1) / 3);
+        palette[3][channel] = static_cast<uint8_t>((palette[0][channel] + 2 * palette[1][channel] + 1) / 3);
+    }
+
+    uint8_t indices[16] = {};
+
+    if (color0 != color1)
+        FindColorIndices(block, palette, indices);
+
+    uint32_t packedIndices = 0;
+
+    for (int32_t i = 0; i < 16; i++)
+        packedIndices |= static_cast<uint32_t>(indices[i]) << (i * 2);
+
+    dst[0] = static_cast<uint8_t>(color0);
+    dst[1] = static_cast<uint8_t>(color0 >> 8);
+    dst[2] = static_cast<uint8_t>(color1);
+    dst[3] = static_cast<uint8_t>(color1 >> 8);
+
+    for (int32_t i = 0; i < 4; i++)
+        dst[4 + i] = static_cast<uint8_t>(packedIndices >> (i * 8));
+}
+
+void BlockEncoder::EncodeAlphaBlock(const uint8_t* block, uint8_t minAlpha, uint8_t maxAlpha, uint8_t* dst)
+{
+    // With the larger alpha first, the block interpolates 6 values between them rather than 4 plus 0 and 255.
+    uint8_t palette[8] = {maxAlpha, minAlpha};
+
+    for (int32_t i = 2; i < 8; i++)
+        palette[i] = static_cast<uint8_t>(((8 - i) * maxAlpha + (i - 1) * minAlpha + 3) / 7);
+
+    uint64_t packedIndices = 0;
+
+    if (maxAlpha != minAlpha)
+    {
+        for (int32_t i = 0; i < 16; i++)
+        {
+            int32_t alpha = block[i * 4 + 3];
+            uint64_t bestIndex = 0;
+            int32_t bestDistance = 256;
+
+            for (int32_t index = 0; index < 8; index++)
+            {
+                int32_t distance = std::abs(alpha - palette[index]);
+
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+
+            packedIndices |= bestIndex << (i * 3);
+        }
+    }
+
+    dst[0] = maxAlpha;
+    dst[1] = minAlpha;
+
+    for (int32_t i = 0; i < 6; i++)
+        dst[2 + i] = static_cast<uint8_t>(packedIndices >> (i * 8));
+}
+
+void BlockEncoder::FindBounds(const uint8_t* block, uint8_t* minColor, uint8_t* maxColor)
+{
+#ifdef GPUVK_SSE2
+    // Four texels per register, the registers and then the texels within them are reduced to one per channel.
+    __m128i minTexels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i maxTexels = minTexels;
+
+    for (int32_t i = 1; i < 4; i++)
+    {
+        __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        minTexels = _mm_min_epu8(minTexels, texels);
+        maxTexels = _mm_max_epu8(maxTexels, texels);
+    }
+
+    minTexels = _mm_min_epu8(minTexels, _mm_srli_si128(minTexels, 8));
+    minTexels = _mm_min_epu8(minTexels, _mm_srli_si128(minTexels, 4));
+    maxTexels = _mm_max_epu8(maxTexels, _mm_srli_si128(maxTexels, 8));
+    maxTexels = _mm_max_epu8(maxTexels, _mm_srli_si128(maxTexels, 4));
+
+    int32_t minValue = _mm_cvtsi128_si32(minTexels);
+    int32_t maxValue = _mm_cvtsi128_si32(maxTexels);
+    std::memcpy(minColor, &minValue, 4);
+    std::memcpy(maxColor, &maxValue, 4);
+#else
+    std::memcpy(minColor, block, 4);
+    std::memcpy(maxColor, block, 4);
+
+    for (int32_t i = 1; i < 16; i++)
+    {
+        for (int32_t channel = 0; channel < 4; channel++)
+        {
+            minColor[channel] = std::min(minColor[channel], block[i * 4 + channel]);
+            maxColor[channel] = std::max(maxColor[channel], block[i * 4 + channel]);
+        }
+    }
+#endif
+}
+
+void BlockEncoder::FindColorIndices(const uint8_t* block, const uint8_t palette[4][4], uint8_t* indices)
+{
+#ifdef GPUVK_SSE2
+    // Four texels at a time, widened to 16 bits so that the squared distance of each pair of channels is summed
+    // with one multiply add. Alpha is masked out of the texels, and is 0 in the palette.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i paletteColors[4];
+
+    for (int32_t index = 0; index < 4; index++)
+    {
+        paletteColors[index] = _mm_setr_epi16(palette[index][0], palette[index][1], palette[index][2], 0,
+            palette[index][0], palette[index][1], palette[index][2], 0);
+    }
+
+    for (int32_t i = 0; i < 16; i += 4)
+    {
+        __m128i texels =
+            _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 4)), colorMask);
+        __m128i lowTexels = _mm_unpacklo_epi8(texels, zero);
+        __m128i highTexels = _mm_unpackhi_epi8(texels, zero);
+
+        __m128i bestDistance = zero;
+        __m128i bestIndex = zero;
+
+        for (int32_t index = 0; index < 4; index++)
+        {
+            __m128i lowDifference = _mm_sub_epi16(lowTexels, paletteColors[index]);
+            __m128i highDifference = _mm_sub_epi16(highTexels, paletteColors[index]);
+            __m128 lowSums = _mm_castsi128_ps(_mm_madd_epi16(lowDifference, lowDifference));
+            __m128 highSums = _mm_castsi128_ps(_mm_madd_epi16(highDifference, highDifference));
+
+            // Each texel has red and green summed in one lane and blue in the next.
+            __m128i distance = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(lowSums, highSums, 0x88)),
+                _mm_castps_si128(_mm_shuffle_ps(lowSums, highSums, 0xDD)));
+
+            if (index == 0)
+            {
+                bestDistance = distance;
+                continue;
+            }
+
+            __m128i isCloser = _mm_cmplt_epi32(distance, bestDistance);
+            bestDistance = _mm_or_si128(_mm_and_si128(isCloser, distance), _mm_andnot_si128(isCloser, bestDistance));
+            bestIndex = _mm_or_si128(
+                _mm_and_si128(isCloser, _mm_set1_epi32(index)), _mm_andnot_si128(isCloser, bestIndex));
+        }
+
+        int32_t bestIndices[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bestIndices), bestIndex);
+
+        for (int32_t j = 0; j < 4; j++)
+            indices[i + j] = static_cast<uint8_t>(bestIndices[j]);
+    }
+#else
+    for (int32_t i = 0; i < 16; i++)
+    {
+        int32_t bestDistance = 0;
+
+        for (int32_t index = 0; index < 4; index++)
+        {
+            int32_t distance = 0;
+
+            for (int32_t channel = 0; channel < 3; channel++)
+            {
+                int32_t difference = block[i * 4 + channel] - palette[index][channel];
+                distance += difference * difference;
+            }
+
+            if (index == 0 || distance < bestDistance)
+            {
+                bestDistance = distance;
+                indices[i] = static_cast<uint8_t>(index);
+            }
+        }
+    }
+#endif
+}
+
+uint16_t BlockEncoder::ToRgb565(const uint8_t* color)
+{
+    uint32_t red = (color[0] * 31 + 127) / 255;
+    uint32_t green = (color[1] * 63 + 127) / 255;
+    uint32_t blue = (color[2] * 31 + 127) / 255;
+
+    return static_cast<uint16_t>((red << 11) | (green << 5) | blue);
+}
+
+void BlockEncoder::FromRgb565(uint16_t value, uint8_t* color)
+{
+    uint32_t red = (value >> 11) & 31;
+    uint32_t green = (value >> 5) & 63;
+    uint32_t blue = value & 31;
+
+    // Repeating the high bits in the low ones maps the largest value to 255, like the GPU does.
+    color[0] = static_cast<uint8_t>((red << 3) | (red >> 2));
+    color[1] = static_cast<uint8_t>((green << 2) | (green >> 4));
+    color[2] = static_cast<uint8_t>((blue << 3) | (blue >> 2));
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GpuVk
+{
+// Compresses RGBA texels into BC1 or BC3 blocks on the CPU, eg. when baking textures. Endpoints are picked from
+// the bounding box of each block's colors, inset slightly and flipped along the diagonal the colors lie on, which is
+// fast enough to run on load and close to what slower encoders get for most textures. Only touches the CPU, so
+// textures can be encoded on other threads.
+class BlockEncoder
+{
+    public:
+    // The format decides the block type, sRGB formats are encoded the same way since the texels are already sRGB.
+    static bool IsFormatSupported(VkFormat format);
+    // Texels are tightly packed RGBA. Blocks that reach past the edge of the image repeat its last row and column.
+    static std::vector<uint8_t> Encode(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format);
+    static size_t GetByteSize(VkFormat format, uint32_t width, uint32_t height);
+
+    private:
+    static void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y,
+        uint8_t* block);
+    static void EncodeColorBlock(const uint8_t* block, const uint8_t* minColor, const uint8_t* maxColor, uint8_t* dst);
+    static void EncodeAlphaBlock(const uint8_t* block, uint8_t minAlpha, uint8_t maxAlpha, uint8_t* dst);
+    // The smallest and largest value of each channel, as RGBA.
+    static void FindBounds(const uint8_t* block, uint8_t* minColor, uint8_t* maxColor);
+    // The index of the closest of the 4 palette colors to each texel, ignoring alpha.
+    static void FindColorIndices(const uint8_t* block, const uint8_t palette[4][4], uint8_t* indices);
+    static uint16_t ToRgb565(const uint8_t* color);
+    static void FromRgb565(uint16_t value, uint8_t* color);
+};
+} // namespace GpuVk
\ No newline at end of file
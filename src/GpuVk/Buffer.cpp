@@ -3,7 +3,8 @@
 
 namespace GpuVk
 {
-Buffer::Buffer(std::shared_ptr<Gpu> gpu, uint64_t byteSize, VkBufferUsageFlags usage, bool cpuAccessible)
+Buffer::Buffer(
+    std::shared_ptr<Gpu> gpu, uint64_t byteSize, VkBufferUsageFlags usage, bool cpuAccessible, bool cpuReadable)
     : _gpu(gpu), _byteSize(byteSize)
 {
     VkBufferCreateInfo bufferInfo{};
@@ -14,7 +15,11 @@ Buffer::Buffer(std::shared_ptr<Gpu> gpu, uint64_t byteSize, VkBufferUsageFlags u
 
     VmaAllocationCreateInfo allocCreateInfo = {};
     allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
-    if (cpuAccessible)
+    if (cpuReadable)
+    {
+        allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
+    else if (cpuAccessible)
     {
         allocCreateInfo.flags =
             VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
@@ -27,6 +32,14 @@ Buffer::Buffer(std::shared_ptr<Gpu> gpu, uint64_t byteSize, VkBufferUsageFlags u
     }
 }
 
+Buffer Buffer::CreateStorage(std::shared_ptr<Gpu> gpu, size_t byteSize)
+{
+    return Buffer(gpu, byteSize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        false);
+}
+
 Buffer::Buffer(Buffer&& other)
 {
     *this = std::move(other);
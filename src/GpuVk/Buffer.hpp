@@ -13,6 +13,14 @@ class Gpu;
 class Buffer
 {
     friend class Image;
+    friend class Descriptors;
+    friend class ComputePipeline;
+    friend class RenderGraph;
+    friend class TextureLoader;
+    friend class TextureAtlas;
+    friend class ReadbackRing;
+    friend class TextureStreamer;
+    friend class StagingRing;
     template <typename V, typename I, typename D> friend class Model;
     template <typename T> friend class UniformBuffer;
 
@@ -53,6 +61,22 @@ class Buffer
         return vertexBuffer;
     }
 
+    // Storage buffers can be written by compute shaders, then used as vertex, index or indirect buffers.
+    template <typename T> static Buffer FromStorageData(std::shared_ptr<Gpu> gpu, const std::vector<T>& data)
+    {
+        VkDeviceSize bufferByteSize = sizeof(T) * data.size();
+
+        Buffer stagingBuffer(gpu, bufferByteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+        stagingBuffer.SetData(data.data());
+
+        Buffer storageBuffer = CreateStorage(gpu, bufferByteSize);
+        stagingBuffer.CopyTo(storageBuffer);
+
+        return storageBuffer;
+    }
+
+    static Buffer CreateStorage(std::shared_ptr<Gpu> gpu, size_t byteSize);
+
     Buffer() = default;
     Buffer(Buffer&& other);
     Buffer& operator=(Buffer&& other);
@@ -65,7 +89,9 @@ class Buffer
     void Unmap();
 
     private:
-    Buffer(std::shared_ptr<Gpu> gpu, uint64_t byteSize, VkBufferUsageFlags usage, bool cpuAccessible);
+    // Buffers that the CPU reads from are kept in cached memory, others that it can access are only written.
+    Buffer(std::shared_ptr<Gpu> gpu, uint64_t byteSize, VkBufferUsageFlags usage, bool cpuAccessible,
+        bool cpuReadable = false);
 
     std::shared_ptr<Gpu> _gpu;
 
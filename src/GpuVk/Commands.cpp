@@ -23,7 +23,10 @@ Commands& Commands::operator=(Commands&& other)
 
     std::swap(_commandPool, other._commandPool);
     std::swap(_buffers, other._buffers);
+    std::swap(_bindStates, other._bindStates);
     std::swap(_currentBufferIndex, other._currentBufferIndex);
+    std::swap(_isRecording, other._isRecording);
+    std::swap(_isInRenderPass, other._isInRenderPass);
 
     return *this;
 }
@@ -52,6 +55,7 @@ void Commands::CreatePool()
 void Commands::CreateBuffers()
 {
     _buffers.resize(MaxFramesInFlight);
+    _bindStates.resize(MaxFramesInFlight);
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -110,16 +114,115 @@ void Commands::BeginBuffer()
 
     if (vkBeginCommandBuffer(_buffers[_currentBufferIndex], &beginInfo) != VK_SUCCESS)
         throw std::runtime_error("Failed to begin recording command buffer!");
+
+    // Nothing is bound in a buffer that has just begun recording.
+    _bindStates[_currentBufferIndex] = BindState{};
+    _isRecording = true;
 }
 
 void Commands::EndBuffer()
 {
     if (vkEndCommandBuffer(_buffers[_currentBufferIndex]) != VK_SUCCESS)
         throw std::runtime_error("Failed to record command buffer!");
+
+    _isRecording = false;
 }
 
 const VkCommandBuffer& Commands::GetBuffer() const
 {
     return _buffers[_currentBufferIndex];
 }
+
+const BindStats& Commands::GetBindStats() const
+{
+    return _bindStates[_currentBufferIndex].Stats;
+}
+
+BindState::PipelineBindings& Commands::GetPipelineBindings(VkPipelineBindPoint bindPoint)
+{
+    auto& bindState = _bindStates[_currentBufferIndex];
+
+    switch (bindPoint)
+    {
+        case VK_PIPELINE_BIND_POINT_GRAPHICS:
+            return bindState.BindPoints[0];
+        case VK_PIPELINE_BIND_POINT_COMPUTE:
+            return bindState.BindPoints[1];
+        default:
+            throw std::runtime_error("Tried to track bindings for an unsupported bind point!");
+    }
+}
+
+void Commands::BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+{
+    auto& stats = _bindStates[_currentBufferIndex].Stats;
+    auto& bindings = GetPipelineBindings(bindPoint);
+
+    if (bindings.Pipeline == pipeline)
+    {
+        stats.Skipped++;
+        return;
+    }
+
+    vkCmdBindPipeline(_buffers[_currentBufferIndex], bindPoint, pipeline);
+    bindings.Pipeline = pipeline;
+    stats.Issued++;
+}
+
+void Commands::BindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, VkDescriptorSet descriptorSet)
+{
+    auto& stats = _bindStates[_currentBufferIndex].Stats;
+    auto& bindings = GetPipelineBindings(bindPoint);
+
+    // The layout is part of the comparison because a set bound with an incompatible layout must be rebound.
+    if (bindings.Layout == layout && bindings.DescriptorSet == descriptorSet)
+    {
+        stats.Skipped++;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(_buffers[_currentBufferIndex], bindPoint, layout, 0, 1, &descriptorSet, 0, nullptr);
+    bindings.Layout = layout;
+    bindings.DescriptorSet = descriptorSet;
+    stats.Issued++;
+}
+
+void Commands::BindVertexBuffer(uint32_t binding, VkBuffer buffer)
+{
+    auto& bindState = _bindStates[_currentBufferIndex];
+    VkDeviceSize offset = 0;
+
+    if (binding >= MaxTrackedVertexBindings)
+    {
+        vkCmdBindVertexBuffers(_buffers[_currentBufferIndex], binding, 1, &buffer, &offset);
+        bindState.Stats.Issued++;
+        return;
+    }
+
+    if (bindState.VertexBuffers[binding] == buffer)
+    {
+        bindState.Stats.Skipped++;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(_buffers[_currentBufferIndex], binding, 1, &buffer, &offset);
+    bindState.VertexBuffers[binding] = buffer;
+    bindState.Stats.Issued++;
+}
+
+void Commands::BindIndexBuffer(VkBuffer buffer, VkIndexType indexType)
+{
+    auto& bindState = _bindStates[_currentBufferIndex];
+
+    if (bindState.IndexBuffer == buffer && bindState.IndexType == indexType)
+    {
+        bindState.Stats.Skipped++;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(_buffers[_currentBufferIndex], buffer, 0, indexType);
+    bindState.IndexBuffer = buffer;
+    bindState.IndexType = indexType;
+    bindState.Stats.Issued++;
+}
 } // namespace GpuVk
\ No newline at end of file
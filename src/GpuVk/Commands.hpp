@@ -5,6 +5,7 @@
 #include <memory>
 #include <vector>
 
+#include "BindState.hpp"
 #include "QueueFamilyIndices.hpp"
 
 namespace GpuVk
@@ -18,13 +19,21 @@ class Commands
     friend class Buffer;
     friend class Image;
     friend class Pipeline;
+    friend class ComputePipeline;
+    friend class Descriptors;
+    friend class RenderGraph;
     friend class RenderPass;
+    friend class TextureLoader;
+    friend class TextureStreamer;
     template <typename V, typename I, typename D> friend class Model;
 
     public:
     void BeginBuffer();
     void EndBuffer();
 
+    // Counts of bind commands issued and skipped as redundant in the buffer currently being recorded.
+    const BindStats& GetBindStats() const;
+
     private:
     Commands() = default;
     Commands(std::shared_ptr<Gpu> gpu);
@@ -38,6 +47,13 @@ class Commands
 
     const VkCommandBuffer& GetBuffer() const;
 
+    // These only record a bind if it differs from what is already bound in the current buffer.
+    void BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+    void BindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, VkDescriptorSet descriptorSet);
+    void BindVertexBuffer(uint32_t binding, VkBuffer buffer);
+    void BindIndexBuffer(VkBuffer buffer, VkIndexType indexType);
+    BindState::PipelineBindings& GetPipelineBindings(VkPipelineBindPoint bindPoint);
+
     VkCommandBuffer BeginSingleTime() const;
     void EndSingleTime(VkCommandBuffer commandBuffer) const;
 
@@ -45,6 +61,10 @@ class Commands
 
     VkCommandPool _commandPool;
     std::vector<VkCommandBuffer> _buffers;
+    std::vector<BindState> _bindStates;
     uint32_t _currentBufferIndex = 0;
+    // Whether the current frame's buffer is between BeginBuffer and EndBuffer, and whether it's inside a render pass.
+    bool _isRecording = false;
+    bool _isInRenderPass = false;
 };
 } // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace GpuVk
+{
+enum class CompareOp
+{
+    Never,
+    Less,
+    Equal,
+    LessOrEqual,
+    Greater,
+    NotEqual,
+    GreaterOrEqual,
+    Always
+};
+} // namespace GpuVk
\ No newline at end of file
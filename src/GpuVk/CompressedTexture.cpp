@@ -0,0 +1,216 @@
+#include "CompressedTexture.hpp"
+#include "File.hpp"
+
+#include <algorithm>
+
+namespace GpuVk
+{
+CompressedTexture CompressedTexture::Read(const std::string& filename)
+{
+    const uint8_t ktx2Identifier[] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    std::vector<char> file = ReadFile(filename);
+
+    if (file.size() >= sizeof(ktx2Identifier) && std::memcmp(file.data(), ktx2Identifier, sizeof(ktx2Identifier)) == 0)
+        return ReadKtx2(file);
+
+    if (file.size() >= 4 && std::memcmp(file.data(), "DDS ", 4) == 0)
+        return ReadDds(file);
+
+    throw std::runtime_error(std::string("Tried to read a compressed texture that isn't a KTX2 or DDS file: ") +
+        filename);
+}
+
+CompressedTexture CompressedTexture::ReadKtx2(const std::vector<char>& file)
+{
+    CompressedTexture texture;
+    texture.Format = static_cast<VkFormat>(ReadValue<uint32_t>(file, 12));
+    texture.Width = ReadValue<uint32_t>(file, 20);
+    texture.Height = std::max(ReadValue<uint32_t>(file, 24), 1u);
+    uint32_t depth = ReadValue<uint32_t>(file, 28);
+    texture.LayerCount = std::max(ReadValue<uint32_t>(file, 32), 1u);
+    uint32_t faceCount = ReadValue<uint32_t>(file, 36);
+    // A level count of 0 asks for mip levels to be generated after loading, which compressed formats can't do.
+    texture.MipmapLevelCount = std::max(ReadValue<uint32_t>(file, 40), 1u);
+    uint32_t supercompressionScheme = ReadValue<uint32_t>(file, 44);
+
+    // Basis Universal data has no Vulkan format, it would have to be transcoded first.
+    if (texture.Format == VK_FORMAT_UNDEFINED)
+        throw std::runtime_error("Tried to read a KTX2 file without a Vulkan format!");
+
+    if (supercompressionScheme != 0)
+        throw std::runtime_error("Tried to read a supercompressed KTX2 file!");
+
+    if (depth > 1 || faceCount != 1)
+        throw std::runtime_error("Tried to read a KTX2 file that isn't a 2D texture or texture array!");
+
+    // The level index follows the 80 byte header and section index. Levels are usually stored from the smallest
+    // up, each containing all of its layers one after another.
+    const size_t levelIndexOffset = 80;
+
+    for (uint32_t level = 0; level < texture.MipmapLevelCount; level++)
+    {
+        size_t levelOffset = levelIndexOffset + level * 3 * sizeof(uint64_t);
+        auto byteOffset = static_cast<size_t>(ReadValue<uint64_t>(file, levelOffset));
+        auto byteLength = static_cast<size_t>(ReadValue<uint64_t>(file, levelOffset + sizeof(uint64_t)));
+        size_t layerByteSize = byteLength / texture.LayerCount;
+
+        for (uint32_t layer = 0; layer < texture.LayerCount; layer++)
+            texture.AddRegion(file, byteOffset + layer * layerByteSize, layerByteSize, level, layer);
+    }
+
+    return texture;
+}
+
+CompressedTexture CompressedTexture::ReadDds(const std::vector<char>& file)
+{
+    const uint32_t fourCcFlag = 0x4;
+    const uint32_t dx10FourCc = 0x30315844;
+    const uint32_t cubeMapFlag = 0x200;
+    const uint32_t volumeFlag = 0x200000;
+    const uint32_t dx10CubeFlag = 0x4;
+
+    CompressedTexture texture;
+    texture.Height = ReadValue<uint32_t>(file, 12);
+    texture.Width = ReadValue<uint32_t>(file, 16);
+    texture.MipmapLevelCount = std::max(ReadValue<uint32_t>(file, 28), 1u);
+    uint32_t pixelFormatFlags = ReadValue<uint32_t>(file, 80);
+    uint32_t fourCc = ReadValue<uint32_t>(file, 84);
+    uint32_t caps2 = ReadValue<uint32_t>(file, 112);
+
+    if (!(pixelFormatFlags & fourCcFlag))
+        throw std::runtime_error("Tried to read a DDS file that isn't block compressed!");
+
+    if (caps2 & (cubeMapFlag | volumeFlag))
+        throw std::runtime_error("Tried to read a DDS file that isn't a 2D texture or texture array!");
+
+    size_t offset = 128;
+
+    if (fourCc == dx10FourCc)
+    {
+        texture.Format = GetVkFormatFromDxgi(ReadValue<uint32_t>(file, 128));
+
+        if (ReadValue<uint32_t>(file, 136) & dx10CubeFlag)
+            throw std::runtime_error("Tried to read a DDS file that isn't a 2D texture or texture array!");
+
+        texture.LayerCount = std::max(ReadValue<uint32_t>(file, 140), 1u);
+        offset += 20;
+    }
+    else
+    {
+        texture.Format = GetVkFormatFromFourCc(fourCc);
+    }
+
+    // Unlike KTX2, DDS stores each layer with all of its mip levels one after another.
+    size_t blockByteSize = GetDdsBlockByteSize(texture.Format);
+
+    for (uint32_t layer = 0; layer < texture.LayerCount; layer++)
+    {
+        for (uint32_t level = 0; level < texture.MipmapLevelCount; level++)
+        {
+            size_t blocksWide = (std::max(texture.Width >> level, 1u) + 3) / 4;
+            size_t blocksHigh = (std::max(texture.Height >> level, 1u) + 3) / 4;
+            size_t byteSize = blocksWide * blocksHigh * blockByteSize;
+
+            texture.AddRegion(file, offset, byteSize, level, layer);
+            offset += byteSize;
+        }
+    }
+
+    return texture;
+}
+
+void CompressedTexture::AddRegion(
+    const std::vector<char>& file, size_t offset, size_t byteSize, uint32_t level, uint32_t layer)
+{
+    if (offset + byteSize > file.size())
+        throw std::runtime_error("Tried to read past the end of a compressed texture file!");
+
+    // Copied into tightly packed data, since offsets in the file aren't always aligned to a block, which buffer to
+    // image copies of compressed formats require.
+    VkBufferImageCopy region{};
+    region.bufferOffset = Data.size();
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = layer;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {std::max(Width >> level, 1u), std::max(Height >> level, 1u), 1};
+    Regions.push_back(region);
+
+    Data.insert(Data.end(), file.begin() + offset, file.begin() + offset + byteSize);
+}
+
+VkFormat CompressedTexture::GetVkFormatFromDxgi(uint32_t dxgiFormat)
+{
+    switch (dxgiFormat)
+    {
+        case 71:
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case 72:
+            return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        case 74:
+            return VK_FORMAT_BC2_UNORM_BLOCK;
+        case 75:
+            return VK_FORMAT_BC2_SRGB_BLOCK;
+        case 77:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case 78:
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case 80:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case 81:
+            return VK_FORMAT_BC4_SNORM_BLOCK;
+        case 83:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case 84:
+            return VK_FORMAT_BC5_SNORM_BLOCK;
+        case 95:
+            return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+        case 96:
+            return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+        case 98:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+        case 99:
+            return VK_FORMAT_BC7_SRGB_BLOCK;
+        default:
+            throw std::runtime_error("Tried to read a DDS file with an unsupported DXGI format!");
+    }
+}
+
+VkFormat CompressedTexture::GetVkFormatFromFourCc(uint32_t fourCc)
+{
+    // Legacy headers don't say whether colors are sRGB, so they're treated as sRGB like other textures, while
+    // single and two channel formats usually hold data like normals and are treated as linear.
+    switch (fourCc)
+    {
+        case 0x31545844: // DXT1
+            return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        case 0x33545844: // DXT3
+            return VK_FORMAT_BC2_SRGB_BLOCK;
+        case 0x35545844: // DXT5
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case 0x31495441: // ATI1
+        case 0x55344342: // BC4U
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case 0x32495441: // ATI2
+        case 0x55354342: // BC5U
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        default:
+            throw std::runtime_error("Tried to read a DDS file with an unsupported compression format!");
+    }
+}
+
+size_t CompressedTexture::GetDdsBlockByteSize(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+            return 8;
+        default:
+            return 16;
+    }
+}
+} // namespace GpuVk
\ No newline at end of file
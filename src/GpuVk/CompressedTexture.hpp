@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace GpuVk
+{
+// Block compressed texture data read from a KTX2 or DDS file, with every mip level and array layer laid out in
+// the order they're uploaded. Only touches the CPU, so files can be read on other threads.
+class CompressedTexture
+{
+    public:
+    // KTX2 files can contain BCn, ETC2 or ASTC data, DDS files BCn data. Supercompressed KTX2 files, cube maps
+    // and 3D textures aren't supported.
+    static CompressedTexture Read(const std::string& filename);
+
+    VkFormat Format = VK_FORMAT_UNDEFINED;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t LayerCount = 1;
+    uint32_t MipmapLevelCount = 1;
+    std::vector<uint8_t> Data;
+    // One copy per mip level and layer, with offsets into Data.
+    std::vector<VkBufferImageCopy> Regions;
+
+    private:
+    // Both containers are little endian, like every platform Vulkan runs on in practice.
+    template <typename T> static T ReadValue(const std::vector<char>& file, size_t offset)
+    {
+        if (offset + sizeof(T) > file.size())
+            throw std::runtime_error("Tried to read past the end of a compressed texture file!");
+
+        T value;
+        std::memcpy(&value, file.data() + offset, sizeof(T));
+
+        return value;
+    }
+
+    static CompressedTexture ReadKtx2(const std::vector<char>& file);
+    static CompressedTexture ReadDds(const std::vector<char>& file);
+
+    void AddRegion(const std::vector<char>& file, size_t offset, size_t byteSize, uint32_t level, uint32_t layer);
+
+    static VkFormat GetVkFormatFromDxgi(uint32_t dxgiFormat);
+    static VkFormat GetVkFormatFromFourCc(uint32_t fourCc);
+    static size_t GetDdsBlockByteSize(VkFormat format);
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "ComputePipeline.hpp"
+#include "File.hpp"
+#include "Pipeline.hpp"
+
+namespace GpuVk
+{
+ComputePipeline::ComputePipeline(std::shared_ptr<Gpu> gpu, const ComputePipelineOptions& computePipelineOptions)
+    : _gpu(gpu)
+{
+    _computeShader = computePipelineOptions.ComputeShader;
+    _enableAutomaticBarriers = computePipelineOptions.EnableAutomaticBarriers;
+    _descriptors = Descriptors(_gpu, computePipelineOptions.DescriptorLayouts);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &_descriptors._layout;
+
+    if (vkCreatePipelineLayout(_gpu->_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create compute pipeline layout!");
+
+    _pipeline = Build(_gpu->_device, _computeShader, _pipelineLayout);
+}
+
+ComputePipeline::ComputePipeline(ComputePipeline&& other)
+{
+    *this = std::move(other);
+}
+
+ComputePipeline& ComputePipeline::operator=(ComputePipeline&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_pipelineLayout, other._pipelineLayout);
+    std::swap(_pipeline, other._pipeline);
+
+    std::swap(_descriptors, other._descriptors);
+
+    std::swap(_computeShader, other._computeShader);
+    std::swap(_enableAutomaticBarriers, other._enableAutomaticBarriers);
+
+    return *this;
+}
+
+ComputePipeline::~ComputePipeline()
+{
+    if (!_gpu)
+        return;
+
+    _gpu->DeferDestroy([device = _gpu->_device, pipeline = _pipeline, pipelineLayout = _pipelineLayout] {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    });
+}
+
+void ComputePipeline::UpdateImage(uint32_t binding, const Image& image, const Sampler& sampler)
+{
+    _descriptors.UpdateImage(binding, image, sampler);
+}
+
+void ComputePipeline::UpdateStorageBuffer(uint32_t binding, const Buffer& buffer)
+{
+    _descriptors.UpdateStorageBuffer(binding, buffer);
+}
+
+void ComputePipeline::UpdateStorageImage(uint32_t binding, const Image& image)
+{
+    _descriptors.UpdateStorageImage(binding, image);
+}
+
+void ComputePipeline::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    VkCommandBuffer commandBuffer = _gpu->Commands.GetBuffer();
+
+    if (_enableAutomaticBarriers)
+        RecordPreDispatchBarrier(commandBuffer);
+
+    Bind();
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+
+    if (_enableAutomaticBarriers)
+        RecordPostDispatchBarrier(commandBuffer);
+}
+
+void ComputePipeline::DispatchIndirect(const Buffer& buffer, size_t offset)
+{
+    if (offset + sizeof(VkDispatchIndirectCommand) > buffer._byteSize)
+        throw std::runtime_error("Tried to dispatch indirectly with an offset past the end of the buffer!");
+
+    VkCommandBuffer commandBuffer = _gpu->Commands.GetBuffer();
+
+    if (_enableAutomaticBarriers)
+        RecordPreDispatchBarrier(commandBuffer);
+
+    Bind();
+    vkCmdDispatchIndirect(commandBuffer, buffer._buffer, static_cast<VkDeviceSize>(offset));
+
+    if (_enableAutomaticBarriers)
+        RecordPostDispatchBarrier(commandBuffer);
+}
+
+VkPipeline ComputePipeline::Build(VkDevice device, const std::string& computeShader, VkPipelineLayout pipelineLayout)
+{
+    auto compShaderCode = ReadFile(computeShader);
+    VkShaderModule compShaderModule = Pipeline::CreateShaderModule(compShaderCode, device);
+
+    VkPipelineShaderStageCreateInfo compShaderStageInfo{};
+    compShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    compShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    compShaderStageInfo.module = compShaderModule;
+    compShaderStageInfo.pName = "main";
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = compShaderStageInfo;
+    pipelineInfo.layout = pipelineLayout;
+
+    VkPipeline pipeline;
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(device, compShaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("Failed to create compute pipeline!");
+
+    return pipeline;
+}
+
+void ComputePipeline::Bind()
+{
+    _gpu->Commands.BindDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, _descriptors.GetCurrentSet());
+    _gpu->Commands.BindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+}
+
+void ComputePipeline::RecordPreDispatchBarrier(VkCommandBuffer commandBuffer)
+{
+    // Wait for earlier graphics, compute and transfer writes before reading or overwriting them.
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask =
+        VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0,
+        nullptr);
+}
+
+void ComputePipeline::RecordPostDispatchBarrier(VkCommandBuffer commandBuffer)
+{
+    // Make the dispatch's writes visible to anything that may consume them afterwards.
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <string>
+
+#include "Buffer.hpp"
+#include "Descriptors.hpp"
+#include "Gpu.hpp"
+#include "PipelineOptions.hpp"
+#include "Sampler.hpp"
+#include "UniformBuffer.hpp"
+
+namespace GpuVk
+{
+class ComputePipeline
+{
+    friend class ShaderHotReload;
+
+    public:
+    ComputePipeline() = default;
+    ComputePipeline(std::shared_ptr<Gpu> gpu, const ComputePipelineOptions& computePipelineOptions);
+    ComputePipeline(ComputePipeline&& other);
+    ComputePipeline& operator=(ComputePipeline&& other);
+    ~ComputePipeline();
+
+    template <typename T> void UpdateUniform(uint32_t binding, const UniformBuffer<T>& uniformBuffer)
+    {
+        _descriptors.UpdateUniform(binding, uniformBuffer);
+    }
+
+    void UpdateImage(uint32_t binding, const Image& image, const Sampler& sampler);
+    void UpdateStorageBuffer(uint32_t binding, const Buffer& buffer);
+    void UpdateStorageImage(uint32_t binding, const Image& image);
+
+    // Dispatches have to be recorded outside of a render pass. Unless disabled, barriers are recorded around each
+    // dispatch so that it sees the results of earlier graphics and compute work, and later work sees its results.
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+    // Reads the group counts from a VkDispatchIndirectCommand in the buffer, eg. one written by another dispatch.
+    void DispatchIndirect(const Buffer& buffer, size_t offset = 0);
+
+    private:
+    static VkPipeline Build(VkDevice device, const std::string& computeShader, VkPipelineLayout pipelineLayout);
+    void Bind();
+    void RecordPreDispatchBarrier(VkCommandBuffer commandBuffer);
+    void RecordPostDispatchBarrier(VkCommandBuffer commandBuffer);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    VkPipelineLayout _pipelineLayout;
+    VkPipeline _pipeline;
+
+    Descriptors _descriptors;
+
+    std::string _computeShader;
+    bool _enableAutomaticBarriers = true;
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "Descriptors.hpp"
+
+namespace GpuVk
+{
+Descriptors::Descriptors(std::shared_ptr<Gpu> gpu, const std::vector<DescriptorLayout>& descriptorLayouts)
+    : _gpu(gpu), _descriptorLayouts(descriptorLayouts)
+{
+    CreateLayout();
+    CreatePool();
+    CreateSets();
+}
+
+Descriptors::Descriptors(Descriptors&& other)
+{
+    *this = std::move(other);
+}
+
+Descriptors& Descriptors::operator=(Descriptors&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_layout, other._layout);
+    std::swap(_pool, other._pool);
+    std::swap(_descriptorSets, other._descriptorSets);
+    std::swap(_descriptorLayouts, other._descriptorLayouts);
+    std::swap(_pendingWrites, other._pendingWrites);
+
+    return *this;
+}
+
+Descriptors::~Descriptors()
+{
+    if (!_gpu)
+        return;
+
+    _gpu->DeferDestroy([device = _gpu->_device, pool = _pool, layout = _layout] {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    });
+}
+
+void Descriptors::UpdateImage(uint32_t binding, const Image& image, const Sampler& sampler)
+{
+    for (uint32_t i = 0; i < MaxFramesInFlight; i++)
+    {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = image._layout;
+        imageInfo.imageView = image._view;
+        imageInfo.sampler = sampler._sampler;
+
+        QueueWrite(i, {binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageInfo, {}});
+    }
+}
+
+void Descriptors::UpdateStorageBuffer(uint32_t binding, const Buffer& buffer)
+{
+    for (uint32_t i = 0; i < MaxFramesInFlight; i++)
+    {
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = buffer._buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+
+        QueueWrite(i, {binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, {}, bufferInfo});
+    }
+}
+
+void Descriptors::UpdateStorageImage(uint32_t binding, const Image& image)
+{
+    if (image._layout != VK_IMAGE_LAYOUT_GENERAL)
+        throw std::runtime_error("Tried to bind an image that wasn't created for storage as a storage image!");
+
+    for (uint32_t i = 0; i < MaxFramesInFlight; i++)
+    {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        imageInfo.imageView = image._view;
+        imageInfo.sampler = VK_NULL_HANDLE;
+
+        QueueWrite(i, {binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, imageInfo, {}});
+    }
+}
+
+void Descriptors::UpdateInputAttachment(uint32_t binding, const Image& image)
+{
+    // Matches the layouts that render passes use for their input attachments.
+    bool isDepth = Image::GetFormatAspectFlags(image._format) & VK_IMAGE_ASPECT_DEPTH_BIT;
+
+    for (uint32_t i = 0; i < MaxFramesInFlight; i++)
+    {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout =
+            isDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = image._view;
+        imageInfo.sampler = VK_NULL_HANDLE;
+
+        QueueWrite(i, {binding, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, imageInfo, {}});
+    }
+}
+
+const VkDescriptorSet& Descriptors::GetCurrentSet()
+{
+    uint32_t frame = _gpu->Commands._currentBufferIndex;
+    ApplyWrites(frame);
+
+    return _descriptorSets[frame];
+}
+
+void Descriptors::QueueWrite(uint32_t frame, const PendingWrite& write)
+{
+    // Sets can be updated while earlier frames still use them, eg. when attachments are recreated on resize
+    // without waiting for the device, so only the latest write to each binding is kept until it can be applied.
+    auto& pendingWrites = _pendingWrites[frame];
+
+    for (auto& pendingWrite : pendingWrites)
+    {
+        if (pendingWrite.Binding == write.Binding)
+        {
+            pendingWrite = write;
+            return;
+        }
+    }
+
+    pendingWrites.push_back(write);
+}
+
+void Descriptors::ApplyWrites(uint32_t frame)
+{
+    auto& pendingWrites = _pendingWrites[frame];
+
+    if (pendingWrites.empty())
+        return;
+
+    std::vector<VkWriteDescriptorSet> descriptorWrites;
+    descriptorWrites.reserve(pendingWrites.size());
+
+    for (const auto& pendingWrite : pendingWrites)
+    {
+        bool isBuffer = pendingWrite.Type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+                        pendingWrite.Type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = _descriptorSets[frame];
+        descriptorWrite.dstBinding = pendingWrite.Binding;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = pendingWrite.Type;
+        descriptorWrite.descriptorCount = 1;
+
+        if (isBuffer)
+            descriptorWrite.pBufferInfo = &pendingWrite.BufferInfo;
+        else
+            descriptorWrite.pImageInfo = &pendingWrite.ImageInfo;
+
+        descriptorWrites.push_back(descriptorWrite);
+    }
+
+    vkUpdateDescriptorSets(_gpu->_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+        nullptr);
+    pendingWrites.clear();
+}
+
+VkDescriptorType Descriptors::GetVkDescriptorType(DescriptorType descriptorType)
+{
+    switch (descriptorType)
+    {
+        case DescriptorType::UniformBuffer:
+            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case DescriptorType::ImageSampler:
+            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        case DescriptorType::StorageBuffer:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case DescriptorType::StorageImage:
+            return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        case DescriptorType::InputAttachment:
+            return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        default:
+            throw std::runtime_error("Tried to get a VkDescriptorType from an invalid descriptor type!");
+    }
+}
+
+VkShaderStageFlags Descriptors::GetVkShaderStageFlags(ShaderStage shaderStage)
+{
+    switch (shaderStage)
+    {
+        case ShaderStage::Vertex:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case ShaderStage::Fragment:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case ShaderStage::Compute:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+        default:
+            throw std::runtime_error("Tried to get VkShaderStageFlags from an invalid shader stage!");
+    }
+}
+
+void Descriptors::CreateLayout()
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    bindings.reserve(_descriptorLayouts.size());
+    for (auto layout : _descriptorLayouts)
+    {
+        VkDescriptorSetLayoutBinding layoutBinding{};
+        layoutBinding.binding = layout.Binding;
+        layoutBinding.descriptorCount = 1;
+        layoutBinding.descriptorType = GetVkDescriptorType(layout.Type);
+        layoutBinding.pImmutableSamplers = nullptr;
+        layoutBinding.stageFlags = GetVkShaderStageFlags(layout.ShaderStage);
+
+        bindings.push_back(layoutBinding);
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(_gpu->_device, &layoutInfo, nullptr, &_layout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor set layout!");
+}
+
+void Descriptors::CreatePool()
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(_descriptorLayouts.size());
+    for (auto layout : _descriptorLayouts)
+    {
+        VkDescriptorPoolSize poolSize;
+        poolSize.type = GetVkDescriptorType(layout.Type);
+        poolSize.descriptorCount = MaxFramesInFlight;
+        poolSizes.push_back(poolSize);
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = static_cast<uint32_t>(MaxFramesInFlight);
+
+    if (vkCreateDescriptorPool(_gpu->_device, &poolInfo, nullptr, &_pool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor pool!");
+}
+
+void Descriptors::CreateSets()
+{
+    std::vector<VkDescriptorSetLayout> layouts(MaxFramesInFlight, _layout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = _pool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(MaxFramesInFlight);
+    allocInfo.pSetLayouts = layouts.data();
+
+    _descriptorSets.resize(MaxFramesInFlight);
+    if (vkAllocateDescriptorSets(_gpu->_device, &allocInfo, _descriptorSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate descriptor sets!");
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "Constants.hpp"
+#include "Gpu.hpp"
+#include "Image.hpp"
+#include "PipelineOptions.hpp"
+#include "Sampler.hpp"
+#include "UniformBuffer.hpp"
+
+namespace GpuVk
+{
+// The descriptor set layout, pool and per-frame descriptor sets shared by graphics and compute pipelines.
+class Descriptors
+{
+    friend class Pipeline;
+    friend class ComputePipeline;
+
+    public:
+    Descriptors() = default;
+    Descriptors(Descriptors&& other);
+    Descriptors& operator=(Descriptors&& other);
+    ~Descriptors();
+
+    private:
+    // A write to one frame's set, which can only be applied once that frame is no longer in flight.
+    struct PendingWrite
+    {
+        uint32_t Binding;
+        VkDescriptorType Type;
+        VkDescriptorImageInfo ImageInfo;
+        VkDescriptorBufferInfo BufferInfo;
+    };
+
+    Descriptors(std::shared_ptr<Gpu> gpu, const std::vector<DescriptorLayout>& descriptorLayouts);
+
+    template <typename T> void UpdateUniform(uint32_t binding, const UniformBuffer<T>& uniformBuffer)
+    {
+        for (uint32_t i = 0; i < MaxFramesInFlight; i++)
+        {
+            VkDescriptorBufferInfo bufferInfo{};
+            bufferInfo.buffer = uniformBuffer.GetBuffer(i);
+            bufferInfo.offset = 0;
+            bufferInfo.range = uniformBuffer.GetDataSize();
+
+            QueueWrite(i, {binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {}, bufferInfo});
+        }
+    }
+
+    void UpdateImage(uint32_t binding, const Image& image, const Sampler& sampler);
+    void UpdateStorageBuffer(uint32_t binding, const Buffer& buffer);
+    void UpdateStorageImage(uint32_t binding, const Image& image);
+    void UpdateInputAttachment(uint32_t binding, const Image& image);
+
+    // Applies the current frame's pending writes first, its previous use has finished by the time it's recorded.
+    const VkDescriptorSet& GetCurrentSet();
+    void QueueWrite(uint32_t frame, const PendingWrite& write);
+    void ApplyWrites(uint32_t frame);
+
+    static VkDescriptorType GetVkDescriptorType(DescriptorType descriptorType);
+    static VkShaderStageFlags GetVkShaderStageFlags(ShaderStage shaderStage);
+    void CreateLayout();
+    void CreatePool();
+    void CreateSets();
+
+    std::shared_ptr<Gpu> _gpu;
+
+    VkDescriptorSetLayout _layout;
+    VkDescriptorPool _pool;
+    std::vector<VkDescriptorSet> _descriptorSets;
+    std::vector<DescriptorLayout> _descriptorLayouts;
+    std::array<std::vector<PendingWrite>, MaxFramesInFlight> _pendingWrites;
+};
+} // namespace GpuVk
\ No newline at end of file
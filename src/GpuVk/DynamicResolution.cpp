@@ -0,0 +1,50 @@
+#include "DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace GpuVk
+{
+// The scale only increases once frames are this far under the target, so it doesn't alternate between two scales.
+const float ScaleUpHeadroom = 0.85f;
+
+DynamicResolution::DynamicResolution(DynamicResolutionOptions options) : _options(options), _scale(options.MaxScale)
+{
+    if (_options.TargetFrameTime <= 0.0f)
+        throw std::runtime_error("Tried to create dynamic resolution with a target frame time that isn't positive!");
+
+    if (_options.MinScale <= 0.0f || _options.MinScale > _options.MaxScale || _options.MaxScale > 1.0f)
+        throw std::runtime_error("Tried to create dynamic resolution with an invalid scale range!");
+}
+
+float DynamicResolution::Update(float frameTime)
+{
+    if (_averageFrameTime == 0.0f)
+        _averageFrameTime = frameTime;
+    else
+        _averageFrameTime += (frameTime - _averageFrameTime) * _options.Smoothing;
+
+    bool isOverTarget = _averageFrameTime > _options.TargetFrameTime;
+    bool isUnderTarget = _averageFrameTime < _options.TargetFrameTime * ScaleUpHeadroom;
+
+    if (!isOverTarget && !isUnderTarget)
+        return _scale;
+
+    // Frame time is assumed to grow with the number of pixels rendered, which is the scale squared.
+    float newScale = _scale * std::sqrt(_options.TargetFrameTime / _averageFrameTime);
+    newScale = std::clamp(newScale, _options.MinScale, _options.MaxScale);
+
+    // Predict the effect of the new scale on the average, so that frames rendered before the change
+    // don't keep pushing the scale further in the same direction.
+    _averageFrameTime *= (newScale * newScale) / (_scale * _scale);
+    _scale = newScale;
+
+    return _scale;
+}
+
+float DynamicResolution::GetScale() const
+{
+    return _scale;
+}
+} // namespace GpuVk
\ No newline at end of file
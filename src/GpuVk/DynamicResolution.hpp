@@ -0,0 +1,26 @@
+#pragma once
+
+#include "RenderPassOptions.hpp"
+
+namespace GpuVk
+{
+// Picks a render scale for a RenderPass from how long recent frames took, trading resolution for frame time when a
+// scene is limited by how many pixels it fills. Frame times should be measured without waiting for vsync, otherwise
+// they never drop below the target and the scale can't recover.
+class DynamicResolution
+{
+    public:
+    DynamicResolution() = default;
+    DynamicResolution(DynamicResolutionOptions options);
+
+    // Takes the time the last frame took in seconds, and returns the scale to render the next frame at.
+    float Update(float frameTime);
+    float GetScale() const;
+
+    private:
+    DynamicResolutionOptions _options;
+
+    float _averageFrameTime = 0.0f;
+    float _scale = 1.0f;
+};
+} // namespace GpuVk
\ No newline at end of file
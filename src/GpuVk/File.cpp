@@ -1,6 +1,18 @@
 #include "File.hpp"
 
 #include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace GpuVk
 {
@@ -21,4 +33,91 @@ std::vector<char> ReadFile(const std::string& filename)
 
     return buffer;
 }
+
+MappedFile::MappedFile(const std::string& filename)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open file!");
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    _size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files can't be mapped, they're left without data instead.
+    if (_size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping)
+        {
+            _data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+    }
+
+    CloseHandle(file);
+#else
+    int file = open(filename.c_str(), O_RDONLY);
+
+    if (file < 0)
+        throw std::runtime_error("Failed to open file!");
+
+    struct stat fileStat;
+    fstat(file, &fileStat);
+    _size = static_cast<size_t>(fileStat.st_size);
+
+    // Empty files can't be mapped, they're left without data instead.
+    if (_size > 0)
+    {
+        void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (data != MAP_FAILED)
+            _data = static_cast<const uint8_t*>(data);
+    }
+
+    close(file);
+#endif
+
+    if (_size > 0 && !_data)
+        throw std::runtime_error("Failed to map file!");
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    if (!_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+#else
+    munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+}
+
+const uint8_t* MappedFile::GetData() const
+{
+    return _data;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return _size;
+}
 } // namespace GpuVk
\ No newline at end of file
@@ -1,9 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace GpuVk
 {
 std::vector<char> ReadFile(const std::string& filename);
-}
\ No newline at end of file
+
+// Maps a whole file into memory read only, so its contents are paged in as they're used instead of read up front.
+class MappedFile
+{
+    public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename);
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    ~MappedFile();
+
+    const uint8_t* GetData() const;
+    size_t GetSize() const;
+
+    private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -97,6 +97,9 @@ void Gpu::CreateAllocator()
     aci.instance = _instance;
     aci.pVulkanFunctions = &vkFuncs;
 
+    if (_supportsMemoryBudget)
+        aci.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+
     vmaCreateAllocator(&aci, &_allocator);
 }
 
@@ -207,8 +210,21 @@ VKAPI_ATTR VkBool32 VKAPI_CALL Gpu::DebugCallback(VkDebugUtilsMessageSeverityFla
 
 void Gpu::Cleanup()
 {
+    // The device is idle by now, so everything that is pending can be destroyed.
+    while (!_pendingDestroys.empty())
+    {
+        _pendingDestroys.front().Destroy();
+        _pendingDestroys.pop_front();
+    }
+
+    // The staging ring's buffer needs to be destroyed before the allocator.
+    _stagingRing = StagingRing();
+
     vmaDestroyAllocator(_allocator);
 
+    for (const auto& cachedSampler : _samplers)
+        vkDestroySampler(_device, cachedSampler.Sampler, nullptr);
+
     for (size_t i = 0; i < MaxFramesInFlight; i++)
     {
         vkDestroySemaphore(_device, _renderFinishedSemaphores[i], nullptr);
@@ -233,6 +249,23 @@ void Gpu::IncrementFrame()
     _currentFrame = (_currentFrame + 1) % MaxFramesInFlight;
     Commands._currentBufferIndex = _currentFrame;
     Swapchain._currentImageIndex = _currentFrame;
+    _frameCount++;
+}
+
+void Gpu::DeferDestroy(std::function<void()> destroy)
+{
+    _pendingDestroys.push_back(PendingDestroy{_frameCount, std::move(destroy)});
+}
+
+void Gpu::DestroyRetired()
+{
+    // Only called after waiting for the current frame's fence, at which point every
+    // frame older than MaxFramesInFlight has finished executing.
+    while (!_pendingDestroys.empty() && _pendingDestroys.front().Frame + MaxFramesInFlight <= _frameCount)
+    {
+        _pendingDestroys.front().Destroy();
+        _pendingDestroys.pop_front();
+    }
 }
 
 VkSemaphore Gpu::GetCurrentImageAvailableSemaphore() const
@@ -250,6 +283,33 @@ const VkFence& Gpu::GetCurrentInFlightFence() const
     return _inFlightFences[_currentFrame];
 }
 
+VkFormat Gpu::FindSupportedFormat(
+    const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
+{
+    for (VkFormat format : candidates)
+    {
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(_physicalDevice, format, &props);
+
+        if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
+        {
+            return format;
+        }
+        else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
+        {
+            return format;
+        }
+    }
+
+    throw std::runtime_error("Failed to find supported format!");
+}
+
+VkFormat Gpu::FindDepthFormat()
+{
+    return FindSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+        VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+}
+
 void Gpu::CreateSurface(SDL_Window* window)
 {
     if (!SDL_Vulkan_CreateSurface(window, _instance, &_surface))
@@ -298,9 +358,25 @@ void Gpu::CreateLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedDeviceFeatures;
+    vkGetPhysicalDeviceFeatures(_physicalDevice, &supportedDeviceFeatures);
+    _supportsNonSolidFill = supportedDeviceFeatures.fillModeNonSolid == VK_TRUE;
+    _supportsSampleRateShading = supportedDeviceFeatures.sampleRateShading == VK_TRUE;
+    _supportsDepthBiasClamp = supportedDeviceFeatures.depthBiasClamp == VK_TRUE;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+    _maxSamplerAnisotropy = properties.limits.maxSamplerAnisotropy;
+
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
-    deviceFeatures.sampleRateShading = VK_TRUE;
+    deviceFeatures.sampleRateShading = supportedDeviceFeatures.sampleRateShading;
+    deviceFeatures.fillModeNonSolid = supportedDeviceFeatures.fillModeNonSolid;
+    deviceFeatures.depthBiasClamp = supportedDeviceFeatures.depthBiasClamp;
+    // Whichever block compression families are available, compressed textures check their format's support.
+    deviceFeatures.textureCompressionBC = supportedDeviceFeatures.textureCompressionBC;
+    deviceFeatures.textureCompressionETC2 = supportedDeviceFeatures.textureCompressionETC2;
+    deviceFeatures.textureCompressionASTC_LDR = supportedDeviceFeatures.textureCompressionASTC_LDR;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -310,8 +386,67 @@ void Gpu::CreateLogicalDevice()
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(DeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = DeviceExtensions.data();
+    std::vector<const char*> enabledExtensions = DeviceExtensions;
+
+    // Dynamic rendering is optional, render passes fall back to render pass objects when it isn't available.
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    if (IsDeviceExtensionSupported(_physicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 supportedFeatures{};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures.pNext = &dynamicRenderingFeatures;
+        vkGetPhysicalDeviceFeatures2(_physicalDevice, &supportedFeatures);
+
+        _supportsDynamicRendering = dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+    }
+
+    if (_supportsDynamicRendering)
+    {
+        enabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        createInfo.pNext = &dynamicRenderingFeatures;
+    }
+
+    // Without memory budgets VMA can only estimate how much of each heap is available to this process.
+    if (IsDeviceExtensionSupported(_physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        _supportsMemoryBudget = true;
+    }
+
+    // Multiview is core since Vulkan 1.1, but it's still an optional feature.
+    VkPhysicalDeviceMultiviewFeatures supportedMultiviewFeatures{};
+    supportedMultiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &supportedMultiviewFeatures;
+    vkGetPhysicalDeviceFeatures2(_physicalDevice, &supportedFeatures);
+
+    VkPhysicalDeviceMultiviewProperties multiviewProperties{};
+    multiviewProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &multiviewProperties;
+    vkGetPhysicalDeviceProperties2(_physicalDevice, &properties);
+
+    _supportsMultiview = supportedMultiviewFeatures.multiview == VK_TRUE;
+    _maxMultiviewViewCount = multiviewProperties.maxMultiviewViewCount;
+
+    VkPhysicalDeviceMultiviewFeatures multiviewFeatures{};
+    multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+    multiviewFeatures.multiview = VK_TRUE;
+
+    if (_supportsMultiview)
+    {
+        multiviewFeatures.pNext = const_cast<void*>(createInfo.pNext);
+        createInfo.pNext = &multiviewFeatures;
+    }
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (EnableValidationLayers)
     {
@@ -328,6 +463,16 @@ void Gpu::CreateLogicalDevice()
 
     vkGetDeviceQueue(_device, indices._graphicsFamily.value(), 0, &_graphicsQueue);
     vkGetDeviceQueue(_device, indices._presentFamily.value(), 0, &_presentQueue);
+
+    if (_supportsDynamicRendering)
+    {
+        _vkCmdBeginRenderingKHR =
+            reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(_device, "vkCmdBeginRenderingKHR"));
+        _vkCmdEndRenderingKHR =
+            reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(_device, "vkCmdEndRenderingKHR"));
+
+        _supportsDynamicRendering = _vkCmdBeginRenderingKHR && _vkCmdEndRenderingKHR;
+    }
 }
 
 bool Gpu::IsDeviceSuitable(VkPhysicalDevice physicalDevice)
@@ -364,4 +509,26 @@ bool Gpu::CheckDeviceExtensionSupport(VkPhysicalDevice device)
 
     return requiredExtensions.empty();
 }
+
+bool Gpu::IsDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName)
+{
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions)
+    {
+        if (strcmp(extension.extensionName, extensionName) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool Gpu::SupportsDynamicRendering() const
+{
+    return _supportsDynamicRendering;
+}
 } // namespace GpuVk
\ No newline at end of file
@@ -5,10 +5,14 @@
 
 #include <vulkan/vulkan.h>
 
+#include <deque>
+#include <functional>
 #include <set>
 #include <vector>
 
 #include "Commands.hpp"
+#include "SamplerOptions.hpp"
+#include "StagingRing.hpp"
 #include "Swapchain.hpp"
 
 namespace GpuVk
@@ -31,22 +35,40 @@ class Gpu
     friend class Swapchain;
     friend class Image;
     friend class Pipeline;
+    friend class ComputePipeline;
+    friend class Descriptors;
+    friend class ShaderHotReload;
+    friend class RenderGraph;
     friend class Buffer;
+    friend class TextureLoader;
+    friend class TextureCache;
+    friend class TextureStreamer;
+    friend class StagingRing;
+    friend class ImageCache;
     template <typename V, typename I, typename D> friend class Model;
 
     public:
     Swapchain Swapchain;
     Commands Commands;
 
+    bool SupportsDynamicRendering() const;
+
     private:
     void Init(SDL_Window* window);
     void Cleanup();
 
     void IncrementFrame();
+    // Runs the destroy function once frames that could have used the resource are no longer in flight.
+    void DeferDestroy(std::function<void()> destroy);
+    void DestroyRetired();
     VkSemaphore GetCurrentImageAvailableSemaphore() const;
     VkSemaphore GetCurrentRenderFinishedSemaphore() const;
     const VkFence& GetCurrentInFlightFence() const;
 
+    VkFormat FindSupportedFormat(
+        const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+    VkFormat FindDepthFormat();
+
     void CreateInstance(SDL_Window* window);
     void CreateAllocator();
     void CreateSyncObjects();
@@ -59,6 +81,7 @@ class Gpu
     bool CheckValidationLayerSupport();
     bool IsDeviceSuitable(VkPhysicalDevice physicalDevice);
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+    bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName);
 
     static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
@@ -77,5 +100,35 @@ class Gpu
     std::vector<VkSemaphore> _renderFinishedSemaphores;
     std::vector<VkFence> _inFlightFences;
     uint32_t _currentFrame = 0;
+    uint64_t _frameCount = 0;
+
+    struct PendingDestroy
+    {
+        uint64_t Frame;
+        std::function<void()> Destroy;
+    };
+
+    std::deque<PendingDestroy> _pendingDestroys;
+
+    StagingRing _stagingRing;
+
+    bool _supportsNonSolidFill = false;
+    bool _supportsSampleRateShading = false;
+    bool _supportsDepthBiasClamp = false;
+    bool _supportsDynamicRendering = false;
+    bool _supportsMultiview = false;
+    bool _supportsMemoryBudget = false;
+    uint32_t _maxMultiviewViewCount = 0;
+    float _maxSamplerAnisotropy = 1.0f;
+
+    struct CachedSampler
+    {
+        SamplerOptions Options;
+        VkSampler Sampler;
+    };
+
+    std::vector<CachedSampler> _samplers;
+    PFN_vkCmdBeginRenderingKHR _vkCmdBeginRenderingKHR = nullptr;
+    PFN_vkCmdEndRenderingKHR _vkCmdEndRenderingKHR = nullptr;
 };
 } // namespace GpuVk
\ No newline at end of file
@@ -1,22 +1,43 @@
 #include "Image.hpp"
 #include "Buffer.hpp"
+#include "CompressedTexture.hpp"
 #include "Gpu.hpp"
+#include "ReadbackRing.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
+#include <cstring>
+
+// Decoded images are swizzled to RGBA with SIMD on x64, which always has SSE2. SSSE3 isn't part of the default
+// target, so its functions are compiled for it separately and only called when the CPU supports it.
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#define GPUVK_SSE2
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GPUVK_TARGET_SSSE3
+#else
+#define GPUVK_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
 namespace GpuVk
 {
-Image::Image(std::shared_ptr<Gpu> gpu, VkImage image, VkFormat format, VkImageAspectFlags viewAspectFlags)
-    : _gpu(gpu), _image(image), _format(format)
+Image::Image(std::shared_ptr<Gpu> gpu, VkImage image, VkFormat format, VkImageAspectFlags viewAspectFlags,
+    uint32_t layerCount)
+    : _gpu(gpu), _image(image), _format(format), _layerCount(layerCount)
 {
     CreateView(viewAspectFlags);
 }
 
 Image::Image(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
-    VkImageAspectFlags viewAspectFlags, uint32_t mipmapLevelCount, uint32_t layerCount, VkSampleCountFlagBits samples)
-    : _gpu(gpu), _format(format), _layerCount(layerCount), _width(width), _height(height),
-      _mipmapLevelCount(mipmapLevelCount)
+    VkImageAspectFlags viewAspectFlags, uint32_t mipmapLevelCount, uint32_t layerCount, VkSampleCountFlagBits samples,
+    bool isArray)
+    : _gpu(gpu), _format(format), _usage(usage), _samples(samples), _layerCount(layerCount), _width(width),
+      _height(height), _mipmapLevelCount(mipmapLevelCount)
 {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -35,6 +56,10 @@ Image::Image(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, VkFormat
     VmaAllocationCreateInfo allocationInfo = {};
     allocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
 
+    // Transient attachments may never need to leave on-chip memory, so they don't need real memory where possible.
+    if (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+        allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
     VkImage image;
     VmaAllocation allocation;
 
@@ -44,7 +69,7 @@ Image::Image(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, VkFormat
     _image = image;
     _allocation = allocation;
 
-    CreateView(viewAspectFlags);
+    CreateView(viewAspectFlags, isArray);
 }
 
 Image::Image(Image&& other)
@@ -60,10 +85,13 @@ Image& Image::operator=(Image&& other)
     std::swap(_view, other._view);
     std::swap(_allocation, other._allocation);
     std::swap(_format, other._format);
+    std::swap(_layout, other._layout);
     std::swap(_layerCount, other._layerCount);
     std::swap(_width, other._width);
     std::swap(_height, other._height);
     std::swap(_mipmapLevelCount, other._mipmapLevelCount);
+    std::swap(_usage, other._usage);
+    std::swap(_samples, other._samples);
 
     return *this;
 }
@@ -86,7 +114,12 @@ Image::~Image()
 void Image::GenerateMipmaps()
 {
     auto commandBuffer = _gpu->Commands.BeginSingleTime();
+    RecordGenerateMipmaps(commandBuffer);
+    _gpu->Commands.EndSingleTime(commandBuffer);
+}
 
+void Image::RecordGenerateMipmaps(VkCommandBuffer commandBuffer) const
+{
     VkImageMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.image = _image;
@@ -151,39 +184,202 @@ void Image::GenerateMipmaps()
 
     vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,
         nullptr, 0, nullptr, 1, &barrier);
+}
 
-    _gpu->Commands.EndSingleTime(commandBuffer);
+StagingAllocation Image::AllocateStaging(
+    std::shared_ptr<Gpu> gpu, VkDeviceSize byteSize, std::shared_ptr<Buffer>& fallbackBuffer)
+{
+    std::optional<StagingAllocation> staging = gpu->_stagingRing.Allocate(byteSize);
+
+    if (staging)
+        return *staging;
+
+    fallbackBuffer = std::make_shared<Buffer>(Buffer(gpu, byteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true));
+
+    return StagingAllocation{
+        fallbackBuffer->_buffer, 0, static_cast<uint8_t*>(fallbackBuffer->_allocationInfo.pMappedData)};
 }
 
-Buffer Image::LoadImage(std::shared_ptr<Gpu> gpu, const std::string& image, int32_t& width, int32_t& height)
+StagingAllocation Image::DecodeToStaging(std::shared_ptr<Gpu> gpu, const std::string& image, int32_t& width,
+    int32_t& height, std::shared_ptr<Buffer>& fallbackBuffer)
 {
-    SDL_Surface* loadedSurface = IMG_Load(image.c_str());
+    SDL_Surface* surface = LoadSurface(image);
 
-    if (!loadedSurface)
-        throw std::runtime_error(std::string("Failed to load image: ") + image);
+    width = surface->w;
+    height = surface->h;
+
+    StagingAllocation staging = AllocateStaging(gpu, static_cast<VkDeviceSize>(width) * height * 4, fallbackBuffer);
+
+    ConvertToRgba(surface, staging.Data);
+    SDL_FreeSurface(surface);
+
+    return staging;
+}
 
-    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
-    SDL_FreeSurface(loadedSurface);
+std::vector<uint8_t> Image::DecodeImage(const std::string& image, int32_t& width, int32_t& height)
+{
+    SDL_Surface* surface = LoadSurface(image);
 
-    auto pixels = reinterpret_cast<uint8_t*>(surface->pixels);
     width = surface->w;
     height = surface->h;
 
-    size_t imageSize = width * height;
-    VkDeviceSize imageByteSize = imageSize * 4;
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    ConvertToRgba(surface, pixels.data());
+    SDL_FreeSurface(surface);
+
+    return pixels;
+}
+
+SDL_Surface* Image::LoadSurface(const std::string& image)
+{
+    SDL_Surface* surface = IMG_Load(image.c_str());
+
+    if (!surface)
+        throw std::runtime_error(std::string("Failed to load image: ") + image);
 
-    Buffer stagingBuffer(gpu, imageByteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
-    stagingBuffer.SetData(pixels);
+    switch (surface->format->format)
+    {
+        case SDL_PIXELFORMAT_RGBA32:
+        case SDL_PIXELFORMAT_BGRA32:
+        case SDL_PIXELFORMAT_RGB24:
+        case SDL_PIXELFORMAT_BGR24:
+            return surface;
+        default:
+            break;
+    }
 
+    // Other formats, eg. paletted images, are rare enough to be left to SDL.
+    SDL_Surface* convertedSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
     SDL_FreeSurface(surface);
 
-    return stagingBuffer;
+    if (!convertedSurface)
+        throw std::runtime_error(std::string("Failed to convert image: ") + image);
+
+    return convertedSurface;
+}
+
+void Image::ConvertToRgba(const SDL_Surface* surface, uint8_t* rgba)
+{
+    size_t width = surface->w;
+
+    // Rows can be padded, so they're converted one at a time into tightly packed texels.
+    for (int32_t y = 0; y < surface->h; y++)
+    {
+        auto src = static_cast<const uint8_t*>(surface->pixels) + static_cast<size_t>(y) * surface->pitch;
+        uint8_t* dst = rgba + y * width * 4;
+
+        switch (surface->format->format)
+        {
+            case SDL_PIXELFORMAT_RGBA32:
+                std::memcpy(dst, src, width * 4);
+                break;
+            case SDL_PIXELFORMAT_BGRA32:
+                SwapRedBlueRow(src, dst, width);
+                break;
+            case SDL_PIXELFORMAT_RGB24:
+                ExpandRgbRow(src, dst, width, false);
+                break;
+            case SDL_PIXELFORMAT_BGR24:
+                ExpandRgbRow(src, dst, width, true);
+                break;
+        }
+    }
+}
+
+void Image::SwapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t width)
+{
+    size_t x = 0;
+
+#ifdef GPUVK_SSE2
+    // Four texels at a time, each one is a little endian 32 bit value with red and blue in the low and high bytes.
+    const __m128i greenAlpha = _mm_set1_epi32(static_cast<int32_t>(0xFF00FF00));
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i red = _mm_and_si128(_mm_srli_epi32(texels, 16), lowByte);
+        __m128i blue = _mm_slli_epi32(_mm_and_si128(texels, lowByte), 16);
+        __m128i swapped = _mm_or_si128(_mm_and_si128(texels, greenAlpha), _mm_or_si128(red, blue));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), swapped);
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+        dst[x * 4 + 0] = src[x * 4 + 2];
+        dst[x * 4 + 1] = src[x * 4 + 1];
+        dst[x * 4 + 2] = src[x * 4 + 0];
+        dst[x * 4 + 3] = src[x * 4 + 3];
+    }
+}
+
+void Image::ExpandRgbRow(const uint8_t* src, uint8_t* dst, size_t width, bool swapRedBlue)
+{
+    static const bool isSsse3Supported = IsSsse3Supported();
+    size_t x = isSsse3Supported ? ExpandRgbRowSsse3(src, dst, width, swapRedBlue) : 0;
+
+    size_t red = swapRedBlue ? 2 : 0;
+    size_t blue = swapRedBlue ? 0 : 2;
+
+    for (; x < width; x++)
+    {
+        dst[x * 4 + 0] = src[x * 3 + red];
+        dst[x * 4 + 1] = src[x * 3 + 1];
+        dst[x * 4 + 2] = src[x * 3 + blue];
+        dst[x * 4 + 3] = 255;
+    }
+}
+
+#ifdef GPUVK_SSE2
+GPUVK_TARGET_SSSE3 size_t Image::ExpandRgbRowSsse3(const uint8_t* src, uint8_t* dst, size_t width, bool swapRedBlue)
+{
+    size_t x = 0;
+
+    // Four texels at a time, shuffling 12 bytes into 16 with an opaque alpha. Each load reads 16 bytes, so the
+    // texels at the end of the row are left to the scalar loop.
+    const __m128i shuffle = swapRedBlue ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+                                        : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000));
+
+    for (; x + 6 <= width; x += 4)
+    {
+        __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3));
+        __m128i expanded = _mm_or_si128(_mm_shuffle_epi8(texels, shuffle), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), expanded);
+    }
+
+    return x;
 }
 
+bool Image::IsSsse3Supported()
+{
+#ifdef _MSC_VER
+    int32_t cpuInfo[4];
+    __cpuid(cpuInfo, 1);
+
+    return (cpuInfo[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+#else
+size_t Image::ExpandRgbRowSsse3(const uint8_t* src, uint8_t* dst, size_t width, bool swapRedBlue)
+{
+    return 0;
+}
+
+bool Image::IsSsse3Supported()
+{
+    return false;
+}
+#endif
+
 Image Image::CreateTexture(std::shared_ptr<Gpu> gpu, const std::string& image, bool enableMipmaps)
 {
     int32_t texWidth, texHeight;
-    Buffer stagingBuffer = LoadImage(gpu, image, texWidth, texHeight);
+    std::shared_ptr<Buffer> fallbackBuffer;
+    StagingAllocation staging = DecodeToStaging(gpu, image, texWidth, texHeight, fallbackBuffer);
     uint32_t mipMapLevels = enableMipmaps ? CalculateMipmapLevelCount(texWidth, texHeight) : 1;
 
     Image textureImage(gpu, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB,
@@ -191,7 +387,7 @@ Image Image::CreateTexture(std::shared_ptr<Gpu> gpu, const std::string& image, b
         VK_IMAGE_ASPECT_COLOR_BIT, mipMapLevels);
 
     textureImage.TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    textureImage.CopyFromBuffer(stagingBuffer);
+    textureImage.CopyFromBuffer(staging.Buffer, staging.Offset);
 
     textureImage.GenerateMipmaps();
 
@@ -202,7 +398,8 @@ Image Image::CreateTextureArray(std::shared_ptr<Gpu> gpu, const std::string& ima
     uint32_t height, uint32_t layers)
 {
     int32_t texWidth, texHeight;
-    Buffer stagingBuffer = LoadImage(gpu, image, texWidth, texHeight);
+    std::shared_ptr<Buffer> fallbackBuffer;
+    StagingAllocation staging = DecodeToStaging(gpu, image, texWidth, texHeight, fallbackBuffer);
     uint32_t mipMapLevels = enableMipmaps ? CalculateMipmapLevelCount(width, height) : 1;
 
     Image textureImage(gpu, width, height, VK_FORMAT_R8G8B8A8_SRGB,
@@ -210,19 +407,138 @@ Image Image::CreateTextureArray(std::shared_ptr<Gpu> gpu, const std::string& ima
         VK_IMAGE_ASPECT_COLOR_BIT, mipMapLevels, layers);
 
     textureImage.TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    textureImage.CopyFromBuffer(stagingBuffer, texWidth, texHeight);
+    textureImage.CopyFromBuffer(staging.Buffer, staging.Offset, texWidth, texHeight);
 
     textureImage.GenerateMipmaps();
 
     return textureImage;
 }
 
-void Image::CreateView(VkImageAspectFlags aspectFlags)
+Image Image::CreateCompressedTexture(std::shared_ptr<Gpu> gpu, const std::string& image)
+{
+    CompressedTexture texture = CompressedTexture::Read(image);
+
+    return CreateFromRegions(gpu, texture.Format, texture.Width, texture.Height, texture.MipmapLevelCount,
+        texture.LayerCount, texture.Data.data(), texture.Data.size(), texture.Regions);
+}
+
+Image Image::CreateFromRegions(std::shared_ptr<Gpu> gpu, VkFormat format, uint32_t width, uint32_t height,
+    uint32_t mipmapLevelCount, uint32_t layerCount, const void* data, size_t byteSize,
+    const std::vector<VkBufferImageCopy>& regions)
+{
+    // Formats from compression families that the GPU doesn't support have no features at all.
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(gpu->_physicalDevice, format, &formatProperties);
+
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        throw std::runtime_error("Tried to create a texture with a format that the GPU can't sample!");
+
+    Buffer stagingBuffer(gpu, byteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    stagingBuffer.SetData(data);
+
+    Image textureImage(gpu, width, height, format, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, mipmapLevelCount, layerCount);
+
+    auto commandBuffer = gpu->Commands.BeginSingleTime();
+
+    textureImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer._buffer, textureImage._image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+    textureImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    gpu->Commands.EndSingleTime(commandBuffer);
+
+    return textureImage;
+}
+
+Image Image::CreateFromPixels(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, ImageFormat format,
+    const void* data, bool enableMipmaps, uint32_t layerCount)
+{
+    VkFormat vkFormat = GetVkFormat(format);
+
+    if (enableMipmaps)
+    {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(gpu->_physicalDevice, vkFormat, &formatProperties);
+
+        // Mip levels are generated with linear blits, which not every format supports, eg. 32 bit floats.
+        VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+        if ((formatProperties.optimalTilingFeatures & blitFeatures) != blitFeatures)
+            throw std::runtime_error("Tried to generate mip levels for a format that can't be blitted!");
+    }
+
+    uint32_t mipMapLevels = enableMipmaps ? CalculateMipmapLevelCount(width, height) : 1;
+    VkDeviceSize layerByteSize = static_cast<VkDeviceSize>(width) * height * GetFormatByteSize(vkFormat);
+
+    std::shared_ptr<Buffer> fallbackBuffer;
+    StagingAllocation staging = AllocateStaging(gpu, layerByteSize * layerCount, fallbackBuffer);
+    std::memcpy(staging.Data, data, layerByteSize * layerCount);
+
+    Image textureImage(gpu, width, height, vkFormat,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, mipMapLevels, layerCount);
+
+    std::vector<VkBufferImageCopy> regions(layerCount);
+
+    for (uint32_t layer = 0; layer < layerCount; layer++)
+    {
+        regions[layer].bufferOffset = staging.Offset + layer * layerByteSize;
+        regions[layer].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[layer].imageSubresource.mipLevel = 0;
+        regions[layer].imageSubresource.baseArrayLayer = layer;
+        regions[layer].imageSubresource.layerCount = 1;
+        regions[layer].imageExtent = {width, height, 1};
+    }
+
+    auto commandBuffer = gpu->Commands.BeginSingleTime();
+
+    textureImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    vkCmdCopyBufferToImage(commandBuffer, staging.Buffer, textureImage._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data());
+
+    textureImage.RecordGenerateMipmaps(commandBuffer);
+
+    gpu->Commands.EndSingleTime(commandBuffer);
+
+    return textureImage;
+}
+
+Image Image::CreateStorage(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, ImageFormat format)
+{
+    VkFormat vkFormat = GetVkFormat(format);
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(gpu->_physicalDevice, vkFormat, &formatProperties);
+
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+        throw std::runtime_error("Tried to create a storage image with a format that doesn't support storage!");
+
+    Image storageImage(gpu, width, height, vkFormat,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT);
+
+    storageImage.TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    storageImage._layout = VK_IMAGE_LAYOUT_GENERAL;
+
+    return storageImage;
+}
+
+void Image::CreateView(VkImageAspectFlags aspectFlags, bool isArray)
 {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = _image;
-    viewInfo.viewType = _layerCount == 1 ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.viewType = _layerCount == 1 && !isArray ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
     viewInfo.format = _format;
     viewInfo.subresourceRange = {};
     viewInfo.subresourceRange.aspectMask = aspectFlags;
@@ -279,6 +595,14 @@ void Image::TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayo
         sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
         destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
     }
+    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL)
+    {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
     else
     {
         throw std::invalid_argument("Unsupported layout transition!");
@@ -289,7 +613,56 @@ void Image::TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayo
     _gpu->Commands.EndSingleTime(commandBuffer);
 }
 
+void Image::RecordBarrier(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage,
+    VkAccessFlags dstAccess) const
+{
+    VkImageMemoryBarrier barrier = CreateBarrier(oldLayout, newLayout, srcAccess, dstAccess);
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+VkImageMemoryBarrier Image::CreateBarrier(
+    VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess) const
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _image;
+    barrier.subresourceRange.aspectMask = GetFormatAspectFlags(_format);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = _mipmapLevelCount;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = _layerCount;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+
+    return barrier;
+}
+
 void Image::CopyFromBuffer(Buffer& src, uint32_t fullWidth, uint32_t fullHeight)
+{
+    CopyFromBuffer(src._buffer, 0, fullWidth, fullHeight);
+}
+
+void Image::CopyFromBuffer(VkBuffer src, VkDeviceSize srcOffset, uint32_t fullWidth, uint32_t fullHeight)
+{
+    auto commandBuffer = _gpu->Commands.BeginSingleTime();
+    RecordCopyFromBuffer(commandBuffer, src, srcOffset, fullWidth, fullHeight);
+    _gpu->Commands.EndSingleTime(commandBuffer);
+}
+
+void Image::RecordCopyFromBuffer(VkCommandBuffer commandBuffer, const Buffer& src, uint32_t fullWidth,
+    uint32_t fullHeight) const
+{
+    RecordCopyFromBuffer(commandBuffer, src._buffer, 0, fullWidth, fullHeight);
+}
+
+void Image::RecordCopyFromBuffer(VkCommandBuffer commandBuffer, VkBuffer src, VkDeviceSize srcOffset,
+    uint32_t fullWidth, uint32_t fullHeight) const
 {
     if (fullWidth == 0)
         fullWidth = _width;
@@ -297,8 +670,6 @@ void Image::CopyFromBuffer(Buffer& src, uint32_t fullWidth, uint32_t fullHeight)
     if (fullHeight == 0)
         fullHeight = _height;
 
-    auto commandBuffer = _gpu->Commands.BeginSingleTime();
-
     std::vector<VkBufferImageCopy> regions;
     uint32_t texPerRow = fullWidth / _width;
 
@@ -308,7 +679,7 @@ void Image::CopyFromBuffer(Buffer& src, uint32_t fullWidth, uint32_t fullHeight)
         uint32_t yLayer = layer / texPerRow;
 
         VkBufferImageCopy region = {};
-        region.bufferOffset = (xLayer * _width + yLayer * _height * fullWidth) * 4;
+        region.bufferOffset = srcOffset + (xLayer * _width + yLayer * _height * fullWidth) * 4;
         region.bufferRowLength = fullWidth;
         region.bufferImageHeight = fullHeight;
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -320,10 +691,235 @@ void Image::CopyFromBuffer(Buffer& src, uint32_t fullWidth, uint32_t fullHeight)
         regions.push_back(region);
     }
 
-    vkCmdCopyBufferToImage(commandBuffer, src._buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    vkCmdCopyBufferToImage(commandBuffer, src, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         static_cast<uint32_t>(regions.size()), regions.data());
+}
 
-    _gpu->Commands.EndSingleTime(commandBuffer);
+void Image::UpdateRegion(const ImageRect& rect, uint32_t layer, uint32_t mipmapLevel, const void* data)
+{
+    if (mipmapLevel >= _mipmapLevelCount || layer >= _layerCount)
+        throw std::runtime_error("Tried to update a mip level or layer that the image doesn't have!");
+
+    uint32_t levelWidth = std::max(_width >> mipmapLevel, 1u);
+    uint32_t levelHeight = std::max(_height >> mipmapLevel, 1u);
+
+    if (rect.X >= levelWidth || rect.Y >= levelHeight)
+        throw std::runtime_error("Tried to update a region outside of the image!");
+
+    uint32_t width = rect.Width == 0 ? levelWidth - rect.X : rect.Width;
+    uint32_t height = rect.Height == 0 ? levelHeight - rect.Y : rect.Height;
+
+    if (width > levelWidth - rect.X || height > levelHeight - rect.Y)
+        throw std::runtime_error("Tried to update a region outside of the image!");
+
+    if (!(_usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+        throw std::runtime_error("Tried to update an image that can't be copied to!");
+
+    if (_gpu->Commands._isInRenderPass)
+        throw std::runtime_error("Tried to update an image inside of a render pass!");
+
+    // Every update gets its own staging memory, tied to the current frame, so earlier versions of the region that
+    // frames in flight are copying from are never overwritten.
+    VkDeviceSize byteSize = static_cast<VkDeviceSize>(width) * height * GetFormatByteSize(_format);
+    std::shared_ptr<Buffer> fallbackBuffer;
+    StagingAllocation staging = AllocateStaging(_gpu, byteSize, fallbackBuffer);
+    std::memcpy(staging.Data, data, byteSize);
+
+    bool isFrameRecording = _gpu->Commands._isRecording;
+    VkCommandBuffer commandBuffer = isFrameRecording ? _gpu->Commands.GetBuffer() : _gpu->Commands.BeginSingleTime();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = _layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _image;
+    barrier.subresourceRange.aspectMask = GetFormatAspectFlags(_format);
+    barrier.subresourceRange.baseMipLevel = mipmapLevel;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = layer;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    // Earlier commands on the queue, eg. from the previous frame, may still be sampling the image.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+        nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = staging.Offset;
+    region.imageSubresource.aspectMask = GetFormatAspectFlags(_format);
+    region.imageSubresource.mipLevel = mipmapLevel;
+    region.imageSubresource.baseArrayLayer = layer;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {static_cast<int32_t>(rect.X), static_cast<int32_t>(rect.Y), 0};
+    region.imageExtent = {width, height, 1};
+
+    vkCmdCopyBufferToImage(commandBuffer, staging.Buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = _layout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0,
+        nullptr, 0, nullptr, 1, &barrier);
+
+    if (isFrameRecording)
+    {
+        if (fallbackBuffer)
+            _gpu->DeferDestroy([fallbackBuffer]() mutable { fallbackBuffer.reset(); });
+
+        return;
+    }
+
+    // Submitted without waiting, frames are submitted to the same queue afterwards so they see the new texels.
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(_gpu->_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit image region update!");
+
+    _gpu->DeferDestroy([device = _gpu->_device, commandPool = _gpu->Commands._commandPool, commandBuffer,
+                           fallbackBuffer]() mutable {
+        fallbackBuffer.reset();
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    });
+}
+
+void Image::ReadbackAsync(ReadbackRing& ring, const ReadbackOptions& options, ReadbackCallback onComplete) const
+{
+    if (options.MipmapLevel >= _mipmapLevelCount || options.Layer >= _layerCount)
+        throw std::runtime_error("Tried to read back a mip level or layer that the image doesn't have!");
+
+    uint32_t levelWidth = std::max(_width >> options.MipmapLevel, 1u);
+    uint32_t levelHeight = std::max(_height >> options.MipmapLevel, 1u);
+
+    if (options.X >= levelWidth || options.Y >= levelHeight)
+        throw std::runtime_error("Tried to read back a region outside of the image!");
+
+    uint32_t width = options.Width == 0 ? levelWidth - options.X : options.Width;
+    uint32_t height = options.Height == 0 ? levelHeight - options.Y : options.Height;
+
+    if (width > levelWidth - options.X || height > levelHeight - options.Y)
+        throw std::runtime_error("Tried to read back a region outside of the image!");
+
+    if (!(_usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+        throw std::runtime_error("Tried to read back an image that can't be copied from!");
+
+    if (_samples != VK_SAMPLE_COUNT_1_BIT)
+        throw std::runtime_error("Tried to read back a multisampled image!");
+
+    if (_gpu->Commands._isInRenderPass)
+        throw std::runtime_error("Tried to read back an image inside of a render pass!");
+
+    size_t byteSize = static_cast<size_t>(width) * height * GetFormatByteSize(_format);
+    std::shared_ptr<Buffer> readbackBuffer = ring.Acquire(byteSize);
+
+    bool isFrameRecording = _gpu->Commands._isRecording;
+    VkCommandBuffer commandBuffer = isFrameRecording ? _gpu->Commands.GetBuffer() : _gpu->Commands.BeginSingleTime();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = _layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _image;
+    barrier.subresourceRange.aspectMask = GetFormatAspectFlags(_format);
+    barrier.subresourceRange.baseMipLevel = options.MipmapLevel;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = options.Layer;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    // Earlier commands in the frame may still be writing the image, eg. the render pass it's an attachment of.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+        nullptr, 0, nullptr, 1, &barrier);
+
+    // A row length and image height of 0 leave the texels tightly packed.
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = GetFormatAspectFlags(_format);
+    region.imageSubresource.mipLevel = options.MipmapLevel;
+    region.imageSubresource.baseArrayLayer = options.Layer;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {static_cast<int32_t>(options.X), static_cast<int32_t>(options.Y), 0};
+    region.imageExtent = {width, height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, _image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer->_buffer, 1,
+        &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = _layout;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = readbackBuffer->_buffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = byteSize;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferBarrier, 1,
+        &barrier);
+
+    // A copy on its own is submitted with a fence, since the texels are read as soon as the deferred work runs.
+    VkFence fence = VK_NULL_HANDLE;
+
+    if (!isFrameRecording)
+    {
+        vkEndCommandBuffer(commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(_gpu->_device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create image readback fence!");
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        if (vkQueueSubmit(_gpu->_graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS)
+        {
+            vkDestroyFence(_gpu->_device, fence, nullptr);
+            throw std::runtime_error("Failed to submit image readback!");
+        }
+    }
+
+    // Deferred work runs once the frame's fence has signaled, which is when a copy recorded into it has finished.
+    // By then a copy submitted on its own has almost always finished too, so waiting for its fence rarely blocks.
+    _gpu->DeferDestroy([allocator = _gpu->_allocator, device = _gpu->_device,
+                           commandPool = _gpu->Commands._commandPool, commandBuffer, fence, readbackBuffer,
+                           freeBuffers = std::weak_ptr(ring._freeBuffers), byteSize, width, height,
+                           onComplete = std::move(onComplete)] {
+        if (fence != VK_NULL_HANDLE)
+        {
+            vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+            vkDestroyFence(device, fence, nullptr);
+            vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        }
+
+        vmaInvalidateAllocation(allocator, readbackBuffer->_allocation, 0, byteSize);
+
+        if (onComplete)
+            onComplete(static_cast<const uint8_t*>(readbackBuffer->_allocationInfo.pMappedData), width, height);
+
+        if (auto ringBuffers = freeBuffers.lock())
+            ringBuffers->push_back(std::move(*readbackBuffer));
+    });
 }
 
 uint32_t Image::CalculateMipmapLevelCount(int32_t texWidth, int32_t texHeight)
@@ -331,6 +927,79 @@ uint32_t Image::CalculateMipmapLevelCount(int32_t texWidth, int32_t texHeight)
     return static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 }
 
+VkImageAspectFlags Image::GetFormatAspectFlags(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_S8_UINT:
+            return VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+VkFormat Image::GetVkFormat(ImageFormat format)
+{
+    switch (format)
+    {
+        case ImageFormat::Rgba8Unorm:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case ImageFormat::Rgba8Srgb:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        case ImageFormat::Rgba16Float:
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case ImageFormat::Rgba32Float:
+            return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case ImageFormat::R32Float:
+            return VK_FORMAT_R32_SFLOAT;
+        case ImageFormat::Rg16Float:
+            return VK_FORMAT_R16G16_SFLOAT;
+        case ImageFormat::B10G11R11UFloat:
+            return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+        case ImageFormat::Rg8Unorm:
+            return VK_FORMAT_R8G8_UNORM;
+        case ImageFormat::R8Unorm:
+            return VK_FORMAT_R8_UNORM;
+        default:
+            throw std::runtime_error("Tried to get a VkFormat from an invalid image format!");
+    }
+}
+
+uint32_t Image::GetFormatByteSize(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8_UNORM:
+            return 1;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_D16_UNORM:
+            return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        default:
+            throw std::runtime_error("Tried to get the texel size of a format that can't be read back!");
+    }
+}
+
 uint32_t Image::GetWidth() const
 {
     return _width;
@@ -1,26 +1,50 @@
 #pragma once
 
 #include "Commands.hpp"
+#include "ImageFormat.hpp"
+#include "ImageRect.hpp"
+#include "ReadbackOptions.hpp"
+#include "StagingRing.hpp"
 
 #include <cmath>
+#include <vector>
 
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.hpp>
 
+struct SDL_Surface;
+
 namespace GpuVk
 {
 class Gpu;
 class Buffer;
+class ReadbackRing;
 
 class Image
 {
     friend class RenderPass;
     friend class Pipeline;
+    friend class Descriptors;
+    friend class RenderGraph;
+    friend class TextureLoader;
+    friend class TextureCache;
+    friend class TextureAtlas;
+    friend class TextureStreamer;
+    friend class ImageCache;
 
     public:
     static Image CreateTexture(std::shared_ptr<Gpu> gpu, const std::string& image, bool enableMipmaps);
     static Image CreateTextureArray(std::shared_ptr<Gpu> gpu, const std::string& image, bool enableMipmaps,
         uint32_t width, uint32_t height, uint32_t layers);
+    // Uploads every mip level and layer of a KTX2 or DDS file as is, so block compressed formats like BC7 take
+    // a fraction of the memory and sampling bandwidth of decoded textures.
+    static Image CreateCompressedTexture(std::shared_ptr<Gpu> gpu, const std::string& image);
+    // Texels are tightly packed, with each layer after the previous one. Mip levels are generated from the first
+    // level when enabled, otherwise they'd have to be filled in with UpdateRegion.
+    static Image CreateFromPixels(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, ImageFormat format,
+        const void* data, bool enableMipmaps = false, uint32_t layerCount = 1);
+    // Storage images stay in the general layout so they can be written by compute shaders and sampled afterwards.
+    static Image CreateStorage(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, ImageFormat format);
 
     Image() = default;
     Image(Image&& other);
@@ -31,16 +55,48 @@ class Image
     uint32_t GetHeight() const;
     uint32_t GetMipmapLevelCount() const;
 
+    // While the current frame's command buffer is recording the copy is recorded into it, which can't be done
+    // inside a render pass. Otherwise it's submitted on its own. The callback runs once the copy has finished on the
+    // GPU, a few frames later, without waiting for it. Render pass attachments can be read back if they're sampled
+    // afterwards, multisampled images can't be copied from until they're resolved.
+    void ReadbackAsync(ReadbackRing& ring, const ReadbackOptions& options, ReadbackCallback onComplete) const;
+    // Copies tightly packed texels into a rectangle of one mip level and layer, eg. for video frames or glyphs.
+    // While the current frame's command buffer is recording the copy is recorded into it, which can't be done
+    // inside a render pass. Otherwise it's submitted on its own, before the next frame. The texels are staged in memory
+    // that isn't reused until the frame is no longer in flight, so updates never overwrite what the GPU reads.
+    void UpdateRegion(const ImageRect& rect, uint32_t layer, uint32_t mipmapLevel, const void* data);
+
     private:
-    Image(std::shared_ptr<Gpu> gpu, VkImage image, VkFormat format, VkImageAspectFlags viewAspectFlags);
+    Image(std::shared_ptr<Gpu> gpu, VkImage image, VkFormat format, VkImageAspectFlags viewAspectFlags,
+        uint32_t layerCount = 1);
+    // Images with a single layer get an array view when asked, eg. so shaders sample them the same way regardless
+    // of how many layers they ended up with.
     Image(std::shared_ptr<Gpu> gpu, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
         VkImageAspectFlags viewAspectFlags, uint32_t mipmapLevelCount = 1, uint32_t layerCount = 1,
-        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT, bool isArray = false);
+
+    // Uploads data that already contains every mip level and layer, eg. from a compressed texture file.
+    static Image CreateFromRegions(std::shared_ptr<Gpu> gpu, VkFormat format, uint32_t width, uint32_t height,
+        uint32_t mipmapLevelCount, uint32_t layerCount, const void* data, size_t byteSize,
+        const std::vector<VkBufferImageCopy>& regions);
 
     void TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout);
+    void RecordBarrier(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout,
+        VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage,
+        VkAccessFlags dstAccess) const;
+    // Creates a barrier covering every mip level and layer, so multiple barriers can be recorded at once.
+    VkImageMemoryBarrier CreateBarrier(
+        VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess) const;
     void CopyFromBuffer(Buffer& src, uint32_t fullWidth = 0, uint32_t fullHeight = 0);
+    void CopyFromBuffer(VkBuffer src, VkDeviceSize srcOffset, uint32_t fullWidth = 0, uint32_t fullHeight = 0);
+    void RecordCopyFromBuffer(VkCommandBuffer commandBuffer, const Buffer& src, uint32_t fullWidth = 0,
+        uint32_t fullHeight = 0) const;
+    void RecordCopyFromBuffer(VkCommandBuffer commandBuffer, VkBuffer src, VkDeviceSize srcOffset,
+        uint32_t fullWidth, uint32_t fullHeight) const;
     void GenerateMipmaps();
-    void CreateView(VkImageAspectFlags aspectFlags);
+    // Also moves every mip level to the shader read only layout, even when there is only one.
+    void RecordGenerateMipmaps(VkCommandBuffer commandBuffer) const;
+    void CreateView(VkImageAspectFlags aspectFlags, bool isArray = false);
 
     std::shared_ptr<Gpu> _gpu;
 
@@ -48,12 +104,38 @@ class Image
     VkImageView _view;
     VmaAllocation _allocation = nullptr;
     VkFormat _format = VK_FORMAT_R32G32B32_SFLOAT;
+    // The layout the image is kept in while it is available to shaders.
+    VkImageLayout _layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    // Unknown for images that weren't created here, eg. swapchain images.
+    VkImageUsageFlags _usage = 0;
+    VkSampleCountFlagBits _samples = VK_SAMPLE_COUNT_1_BIT;
     uint32_t _layerCount = 1;
     uint32_t _width = 0;
     uint32_t _height = 0;
     uint32_t _mipmapLevelCount = 1;
 
-    static Buffer LoadImage(std::shared_ptr<Gpu> gpu, const std::string& image, int32_t& width, int32_t& height);
+    // Falls back to a buffer of its own when the staging ring is full, which is kept until the frame has finished.
+    static StagingAllocation AllocateStaging(std::shared_ptr<Gpu> gpu, VkDeviceSize byteSize,
+        std::shared_ptr<Buffer>& fallbackBuffer);
+    // Converts straight into the GPU's staging ring when there is room, or into the fallback buffer otherwise.
+    // SDL_image only decodes into surfaces it allocates, so the texels are still decoded once into a surface and
+    // then copied, only the separate RGBA conversion and staging buffer are skipped.
+    static StagingAllocation DecodeToStaging(std::shared_ptr<Gpu> gpu, const std::string& image, int32_t& width,
+        int32_t& height, std::shared_ptr<Buffer>& fallbackBuffer);
+    // Only touches the CPU, so images can be decoded on other threads.
+    static std::vector<uint8_t> DecodeImage(const std::string& image, int32_t& width, int32_t& height);
+    // Keeps the decoded format when it can be converted to RGBA while copying out of the surface, otherwise SDL
+    // converts it into another surface first.
+    static SDL_Surface* LoadSurface(const std::string& image);
+    static void ConvertToRgba(const SDL_Surface* surface, uint8_t* rgba);
+    static void SwapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t width);
+    static void ExpandRgbRow(const uint8_t* src, uint8_t* dst, size_t width, bool swapRedBlue);
+    // Returns how many texels were expanded, the rest of the row is left to ExpandRgbRow.
+    static size_t ExpandRgbRowSsse3(const uint8_t* src, uint8_t* dst, size_t width, bool swapRedBlue);
+    static bool IsSsse3Supported();
     static uint32_t CalculateMipmapLevelCount(int32_t texWidth, int32_t texHeight);
+    static VkImageAspectFlags GetFormatAspectFlags(VkFormat format);
+    static VkFormat GetVkFormat(ImageFormat format);
+    static uint32_t GetFormatByteSize(VkFormat format);
 };
 } // namespace GpuVk
\ No newline at end of file
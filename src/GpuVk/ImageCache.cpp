@@ -0,0 +1,146 @@
+#include "ImageCache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <vector>
+
+namespace GpuVk
+{
+ImageCache::ImageCache(std::shared_ptr<Gpu> gpu, float budgetFraction) : _gpu(gpu), _budgetFraction(budgetFraction)
+{
+}
+
+std::shared_ptr<const Image> ImageCache::Get(const std::string& image, const ImageLoadOptions& options)
+{
+    if (!_gpu)
+        throw std::runtime_error("Tried to get an image without initializing the image cache!");
+
+    std::string key = GetKey(image, options);
+    auto it = _entries.find(key);
+
+    if (it == _entries.end())
+    {
+        auto handle = std::make_shared<const Image>(Load(image, options));
+
+        VmaAllocationInfo allocationInfo;
+        vmaGetAllocationInfo(_gpu->_allocator, handle->_allocation, &allocationInfo);
+
+        it = _entries.emplace(key, Entry{handle, allocationInfo.size, 0}).first;
+    }
+
+    it->second.LastUsedFrame = _gpu->_frameCount;
+
+    return it->second.Handle;
+}
+
+void ImageCache::Update()
+{
+    if (!_gpu)
+        return;
+
+    // Images that still have handles outside of the cache are assumed to be in use.
+    for (auto& [key, entry] : _entries)
+    {
+        if (entry.Handle.use_count() > 1)
+            entry.LastUsedFrame = _gpu->_frameCount;
+    }
+
+    while (!_evictions.empty() && _evictions.front().Frame + MaxFramesInFlight < _gpu->_frameCount)
+        _evictions.pop_front();
+
+    uint64_t overBudgetByteSize = GetOverBudgetByteSize();
+
+    if (overBudgetByteSize == 0)
+        return;
+
+    std::vector<std::unordered_map<std::string, Entry>::iterator> unreferenced;
+
+    for (auto it = _entries.begin(); it != _entries.end(); it++)
+    {
+        if (it->second.Handle.use_count() == 1)
+            unreferenced.push_back(it);
+    }
+
+    std::sort(unreferenced.begin(), unreferenced.end(),
+        [](const auto& a, const auto& b) { return a->second.LastUsedFrame < b->second.LastUsedFrame; });
+
+    uint64_t evictedByteSize = 0;
+
+    for (size_t i = 0; i < unreferenced.size() && evictedByteSize < overBudgetByteSize; i++)
+    {
+        Entry& entry = unreferenced[i]->second;
+
+        // Handles could have been released during a frame that is still in flight.
+        _gpu->DeferDestroy([handle = std::move(entry.Handle)]() mutable { handle.reset(); });
+        _evictions.push_back(Eviction{_gpu->_frameCount, entry.ByteSize});
+        evictedByteSize += entry.ByteSize;
+
+        _entries.erase(unreferenced[i]);
+    }
+}
+
+size_t ImageCache::GetImageCount() const
+{
+    return _entries.size();
+}
+
+Image ImageCache::Load(const std::string& image, const ImageLoadOptions& options) const
+{
+    std::string extension = std::filesystem::path(image).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (extension == ".ktx2" || extension == ".dds")
+        return Image::CreateCompressedTexture(_gpu, image);
+
+    if (options.LayerCount > 1)
+    {
+        return Image::CreateTextureArray(
+            _gpu, image, options.EnableMipmaps, options.LayerWidth, options.LayerHeight, options.LayerCount);
+    }
+
+    return Image::CreateTexture(_gpu, image, options.EnableMipmaps);
+}
+
+uint64_t ImageCache::GetOverBudgetByteSize() const
+{
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(_gpu->_allocator, &memoryProperties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(_gpu->_allocator, budgets);
+
+    uint64_t usage = 0;
+    uint64_t budget = 0;
+
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+    {
+        if ((memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0)
+            continue;
+
+        usage += budgets[i].usage;
+        budget += budgets[i].budget;
+    }
+
+    for (const Eviction& eviction : _evictions)
+        usage -= std::min(usage, eviction.ByteSize);
+
+    auto allowedUsage = static_cast<uint64_t>(budget * static_cast<double>(_budgetFraction));
+
+    return usage > allowedUsage ? usage - allowedUsage : 0;
+}
+
+std::string ImageCache::GetKey(const std::string& image, const ImageLoadOptions& options)
+{
+    std::string key = std::filesystem::path(image).lexically_normal().generic_string();
+    key += options.EnableMipmaps ? "|mipmaps" : "|nomipmaps";
+
+    if (options.LayerCount > 1)
+    {
+        key += "|" + std::to_string(options.LayerCount) + "x" + std::to_string(options.LayerWidth) + "x" +
+               std::to_string(options.LayerHeight);
+    }
+
+    return key;
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Gpu.hpp"
+#include "Image.hpp"
+#include "ImageLoadOptions.hpp"
+
+namespace GpuVk
+{
+// Shares images that are loaded from the same file with the same options, instead of loading a copy for each user.
+// Images stay cached after their last handle is released, until device local memory use exceeds a fraction of its
+// budget, then the least recently used ones are evicted.
+class ImageCache
+{
+    public:
+    ImageCache() = default;
+    ImageCache(std::shared_ptr<Gpu> gpu, float budgetFraction = 0.8f);
+
+    // Loads the image the first time it's requested, KTX2 and DDS files are loaded as compressed textures.
+    std::shared_ptr<const Image> Get(const std::string& image, const ImageLoadOptions& options = ImageLoadOptions());
+
+    // Evicts unreferenced images when over budget, call this once per frame, eg. in IRenderer::Update.
+    void Update();
+
+    size_t GetImageCount() const;
+
+    private:
+    struct Entry
+    {
+        std::shared_ptr<const Image> Handle;
+        uint64_t ByteSize;
+        uint64_t LastUsedFrame;
+    };
+
+    struct Eviction
+    {
+        uint64_t Frame;
+        uint64_t ByteSize;
+    };
+
+    Image Load(const std::string& image, const ImageLoadOptions& options) const;
+    // How much device local memory has to be freed to get back under budget, if any.
+    uint64_t GetOverBudgetByteSize() const;
+
+    static std::string GetKey(const std::string& image, const ImageLoadOptions& options);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    std::unordered_map<std::string, Entry> _entries;
+    // Evicted images are destroyed once frames in flight are done with them, until then they still count towards
+    // the heap budgets, so they're tracked to avoid evicting more than needed.
+    std::deque<Eviction> _evictions;
+    float _budgetFraction = 0.8f;
+};
+} // namespace GpuVk
\ No newline at end of file
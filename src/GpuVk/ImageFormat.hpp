@@ -0,0 +1,17 @@
+#pragma once
+
+namespace GpuVk
+{
+enum class ImageFormat
+{
+    Rgba8Unorm,
+    Rgba8Srgb,
+    Rgba16Float,
+    Rgba32Float,
+    R32Float,
+    Rg16Float,
+    B10G11R11UFloat,
+    Rg8Unorm,
+    R8Unorm
+};
+} // namespace GpuVk
\ No newline at end of file
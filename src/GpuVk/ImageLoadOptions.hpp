@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace GpuVk
+{
+struct ImageLoadOptions
+{
+    // Ignored by KTX2 and DDS files, which are loaded with the mip levels they contain.
+    bool EnableMipmaps = true;
+    // More than one layer loads the image as a texture array, where each layer is a tile of the layer size.
+    uint32_t LayerCount = 1;
+    uint32_t LayerWidth = 0;
+    uint32_t LayerHeight = 0;
+};
+} // namespace GpuVk
\ No newline at end of file
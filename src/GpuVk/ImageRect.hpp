@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace GpuVk
+{
+// A rectangle of texels in a mip level, a width or height of 0 extends it to the edge of the level.
+struct ImageRect
+{
+    uint32_t X = 0;
+    uint32_t Y = 0;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -44,10 +44,9 @@ template <typename V, typename I, typename D> class Model
 
         auto commandBuffer = _gpu->Commands.GetBuffer();
 
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &_vertexBuffer._buffer, offsets);
-        vkCmdBindVertexBuffers(commandBuffer, 1, 1, &_instanceBuffer._buffer, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, _indexBuffer._buffer, 0, indexType);
+        _gpu->Commands.BindVertexBuffer(0, _vertexBuffer._buffer);
+        _gpu->Commands.BindVertexBuffer(1, _instanceBuffer._buffer);
+        _gpu->Commands.BindIndexBuffer(_indexBuffer._buffer, indexType);
         vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(_size), static_cast<uint32_t>(_instanceCount), 0, 0, 0);
     }
 
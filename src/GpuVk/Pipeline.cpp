@@ -1,12 +1,36 @@
 #include "Pipeline.hpp"
 #include "File.hpp"
 
+#include <cstring>
+
 namespace GpuVk
 {
 Pipeline::Pipeline(std::shared_ptr<Gpu> gpu, const PipelineOptions& pipelineOptions, const RenderPass& renderPass)
     : _gpu(gpu)
 {
-    Create(pipelineOptions, renderPass);
+    Create(pipelineOptions, GetRenderTarget(renderPass, pipelineOptions.Subpass), nullptr);
+}
+
+Pipeline::Pipeline(std::shared_ptr<Gpu> gpu, const PipelineOptions& pipelineOptions, const RenderPass& renderPass,
+    const Pipeline& basePipeline)
+    : _gpu(gpu)
+{
+    Create(pipelineOptions, GetRenderTarget(renderPass, pipelineOptions.Subpass), &basePipeline);
+}
+
+Pipeline::Pipeline(std::shared_ptr<Gpu> gpu, const PipelineOptions& pipelineOptions, const RenderGraph& renderGraph,
+    RenderGraphPass pass)
+    : _gpu(gpu)
+{
+    if (!_gpu->SupportsDynamicRendering())
+        throw std::runtime_error("Tried to create a pipeline for a render graph pass without dynamic rendering!");
+
+    RenderTarget target{};
+    target.UseDynamicRendering = true;
+    target.ColorFormats = renderGraph.GetColorFormats(pass);
+    target.DepthFormat = renderGraph.GetDepthFormat(pass);
+
+    Create(pipelineOptions, target, nullptr);
 }
 
 Pipeline::Pipeline(Pipeline&& other)
@@ -21,12 +45,10 @@ Pipeline& Pipeline::operator=(Pipeline&& other)
     std::swap(_pipelineLayout, other._pipelineLayout);
     std::swap(_pipeline, other._pipeline);
 
-    std::swap(_descriptorSetLayout, other._descriptorSetLayout);
-    std::swap(_descriptorPool, other._descriptorPool);
-    std::swap(_descriptorSets, other._descriptorSets);
-    std::swap(_descriptorLayouts, other._descriptorLayouts);
+    std::swap(_descriptors, other._descriptors);
 
-    std::swap(_enableTransparency, other._enableTransparency);
+    std::swap(_options, other._options);
+    std::swap(_target, other._target);
 
     return *this;
 }
@@ -36,129 +58,51 @@ Pipeline::~Pipeline()
     if (!_gpu)
         return;
 
-    vkDestroyPipeline(_gpu->_device, _pipeline, nullptr);
-    vkDestroyPipelineLayout(_gpu->_device, _pipelineLayout, nullptr);
-    vkDestroyDescriptorPool(_gpu->_device, _descriptorPool, nullptr);
-    vkDestroyDescriptorSetLayout(_gpu->_device, _descriptorSetLayout, nullptr);
+    // The pipeline may still be in use by frames that are in flight.
+    _gpu->DeferDestroy([device = _gpu->_device, pipeline = _pipeline, pipelineLayout = _pipelineLayout] {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    });
 }
 
 void Pipeline::UpdateImage(uint32_t binding, const Image& image, const Sampler& sampler)
 {
-    for (uint32_t i = 0; i < MaxFramesInFlight; i++)
-    {
-        VkDescriptorImageInfo imageInfo{};
-        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        imageInfo.imageView = image._view;
-        imageInfo.sampler = sampler._sampler;
-
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = _descriptorSets[i];
-        descriptorWrite.dstBinding = binding;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pImageInfo = &imageInfo;
-
-        vkUpdateDescriptorSets(_gpu->_device, 1, &descriptorWrite, 0, nullptr);
-    }
+    _descriptors.UpdateImage(binding, image, sampler);
 }
 
-VkDescriptorType Pipeline::GetVkDescriptorType(DescriptorType descriptorType)
+void Pipeline::UpdateStorageBuffer(uint32_t binding, const Buffer& buffer)
 {
-    switch (descriptorType)
-    {
-        case DescriptorType::UniformBuffer:
-            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        case DescriptorType::ImageSampler:
-            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        default:
-            throw std::runtime_error("Tried to get a VkDescriptorType from an invalid descriptor type!");
-    }
+    _descriptors.UpdateStorageBuffer(binding, buffer);
 }
 
-void Pipeline::CreateDescriptorSetLayout()
+void Pipeline::UpdateStorageImage(uint32_t binding, const Image& image)
 {
-    std::vector<VkDescriptorSetLayoutBinding> bindings;
-    bindings.reserve(_descriptorLayouts.size());
-    for (auto layout : _descriptorLayouts)
-    {
-        VkDescriptorSetLayoutBinding layoutBinding{};
-        layoutBinding.binding = layout.Binding;
-        layoutBinding.descriptorCount = 1;
-        layoutBinding.descriptorType = GetVkDescriptorType(layout.Type);
-        layoutBinding.pImmutableSamplers = nullptr;
-
-        switch (layout.ShaderStage)
-        {
-            case ShaderStage::Vertex:
-                layoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-                break;
-            case ShaderStage::Fragment:
-                layoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-                break;
-        }
-
-        bindings.push_back(layoutBinding);
-    }
-
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    if (vkCreateDescriptorSetLayout(_gpu->_device, &layoutInfo, nullptr, &_descriptorSetLayout) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create descriptor set layout!");
-}
-
-void Pipeline::CreateDescriptorPool()
-{
-    std::vector<VkDescriptorPoolSize> poolSizes;
-    poolSizes.reserve(_descriptorLayouts.size());
-    for (auto layout : _descriptorLayouts)
-    {
-        VkDescriptorPoolSize poolSize;
-        poolSize.type = GetVkDescriptorType(layout.Type);
-        poolSize.descriptorCount = MaxFramesInFlight;
-        poolSizes.push_back(poolSize);
-    }
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(MaxFramesInFlight);
-
-    if (vkCreateDescriptorPool(_gpu->_device, &poolInfo, nullptr, &_descriptorPool) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create descriptor pool!");
+    _descriptors.UpdateStorageImage(binding, image);
 }
 
-void Pipeline::CreateDescriptorSets()
+void Pipeline::UpdateInputAttachment(uint32_t binding, const Image& image)
 {
-    std::vector<VkDescriptorSetLayout> layouts(MaxFramesInFlight, _descriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = _descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MaxFramesInFlight);
-    allocInfo.pSetLayouts = layouts.data();
-
-    _descriptorSets.resize(MaxFramesInFlight);
-    if (vkAllocateDescriptorSets(_gpu->_device, &allocInfo, _descriptorSets.data()) != VK_SUCCESS)
-        throw std::runtime_error("Failed to allocate descriptor sets!");
+    _descriptors.UpdateInputAttachment(binding, image);
 }
 
-std::array<VkVertexInputBindingDescription, 2> Pipeline::CreateVertexInputBindingDescriptions(
+std::vector<VkVertexInputBindingDescription> Pipeline::CreateVertexInputBindingDescriptions(
     const PipelineOptions& pipelineOptions)
 {
-    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions;
+    const VertexOptions& vertexOptions = pipelineOptions.VertexDataOptions;
+    const VertexOptions& instanceOptions = pipelineOptions.InstanceDataOptions;
+    bool hasVertexData = vertexOptions.Size != 0 || !vertexOptions.VertexAttributes.empty();
+    bool hasInstanceData = instanceOptions.Size != 0 || !instanceOptions.VertexAttributes.empty();
+
+    if (hasVertexData && hasInstanceData && vertexOptions.Binding == instanceOptions.Binding)
+        throw std::runtime_error("Tried to create a pipeline with vertex and instance data in the same binding!");
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions;
 
-    bindingDescriptions[0].binding = pipelineOptions.VertexDataOptions.Binding;
-    bindingDescriptions[0].stride = pipelineOptions.VertexDataOptions.Size;
-    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    if (hasVertexData)
+        bindingDescriptions.push_back({vertexOptions.Binding, vertexOptions.Size, VK_VERTEX_INPUT_RATE_VERTEX});
 
-    bindingDescriptions[1].binding = pipelineOptions.InstanceDataOptions.Binding;
-    bindingDescriptions[1].stride = pipelineOptions.InstanceDataOptions.Size;
-    bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    if (hasInstanceData)
+        bindingDescriptions.push_back({instanceOptions.Binding, instanceOptions.Size, VK_VERTEX_INPUT_RATE_INSTANCE});
 
     return bindingDescriptions;
 }
@@ -182,20 +126,112 @@ std::vector<VkVertexInputAttributeDescription> Pipeline::CreateVertexInputAttrib
     return attributeDescriptions;
 }
 
-void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderPass& renderPass)
+std::vector<VkPipelineColorBlendAttachmentState> Pipeline::CreateColorBlendAttachmentStates(
+    const PipelineOptions& pipelineOptions, size_t colorAttachmentCount)
+{
+    std::vector<BlendOptions> blendOptions = pipelineOptions.ColorBlending;
+
+    if (blendOptions.empty())
+    {
+        BlendOptions defaultBlendOptions{};
+        defaultBlendOptions.EnableBlending = pipelineOptions.EnableTransparency;
+        blendOptions.resize(colorAttachmentCount, defaultBlendOptions);
+    }
+
+    std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+    colorBlendAttachments.reserve(blendOptions.size());
+
+    for (const auto& options : blendOptions)
+    {
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+
+        if (options.EnableColorWrites)
+        {
+            colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                                  VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        }
+
+        colorBlendAttachment.blendEnable = options.EnableBlending ? VK_TRUE : VK_FALSE;
+        colorBlendAttachment.srcColorBlendFactor = GetVkBlendFactor(options.SrcColorFactor);
+        colorBlendAttachment.dstColorBlendFactor = GetVkBlendFactor(options.DstColorFactor);
+        colorBlendAttachment.colorBlendOp = GetVkBlendOp(options.ColorOp);
+        colorBlendAttachment.srcAlphaBlendFactor = GetVkBlendFactor(options.SrcAlphaFactor);
+        colorBlendAttachment.dstAlphaBlendFactor = GetVkBlendFactor(options.DstAlphaFactor);
+        colorBlendAttachment.alphaBlendOp = GetVkBlendOp(options.AlphaOp);
+
+        colorBlendAttachments.push_back(colorBlendAttachment);
+    }
+
+    return colorBlendAttachments;
+}
+
+Pipeline::RenderTarget Pipeline::GetRenderTarget(const RenderPass& renderPass, uint32_t subpass)
+{
+    RenderTarget target{};
+    target.RenderPass = renderPass._renderPass;
+    target.UseDynamicRendering = renderPass.IsUsingDynamicRendering();
+    target.ColorFormats = renderPass.GetColorFormats(subpass);
+    target.DepthFormat = renderPass._options.EnableDepth ? renderPass._depthFormat : VK_FORMAT_UNDEFINED;
+    target.SampleCount = renderPass._msaaSampleCount;
+    target.Subpass = subpass;
+    target.ViewMask = renderPass._options.ViewMask;
+
+    return target;
+}
+
+void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderTarget& target, const Pipeline* basePipeline)
 {
-    _descriptorLayouts = pipelineOptions.DescriptorLayouts;
-    _enableTransparency = pipelineOptions.EnableTransparency;
+    _options = pipelineOptions;
+    _target = target;
+
+    if (basePipeline && !basePipeline->_options.AllowDerivatives)
+        throw std::runtime_error("Tried to derive a pipeline from a base pipeline that doesn't allow derivatives!");
+
+    bool isStripOrFan = pipelineOptions.Topology == PrimitiveTopology::TriangleStrip ||
+                        pipelineOptions.Topology == PrimitiveTopology::TriangleFan ||
+                        pipelineOptions.Topology == PrimitiveTopology::LineStrip;
+
+    if (pipelineOptions.EnablePrimitiveRestart && !isStripOrFan)
+        throw std::runtime_error("Primitive restart can only be enabled for strip and fan topologies!");
+
+    if (pipelineOptions.PolygonMode != RasterMode::Fill && !_gpu->_supportsNonSolidFill)
+        throw std::runtime_error("Line and point polygon modes aren't supported by the GPU!");
 
-    CreateDescriptorSetLayout();
-    CreateDescriptorPool();
-    CreateDescriptorSets();
+    if (pipelineOptions.EnableDepthBias && pipelineOptions.DepthBiasClamp != 0.0f && !_gpu->_supportsDepthBiasClamp)
+        throw std::runtime_error("Depth bias clamping isn't supported by the GPU!");
 
+    if (pipelineOptions.EnableSampleShading && !_gpu->_supportsSampleRateShading)
+        throw std::runtime_error("Sample shading isn't supported by the GPU!");
+
+    if (pipelineOptions.FragmentShader.empty() && !_target.ColorFormats.empty())
+        throw std::runtime_error("Tried to create a pipeline without a fragment shader that renders to color!");
+
+    if (!pipelineOptions.ColorBlending.empty() && pipelineOptions.ColorBlending.size() != _target.ColorFormats.size())
+        throw std::runtime_error("Tried to create a pipeline with blend options that don't match its attachments!");
+
+    _descriptors = Descriptors(_gpu, pipelineOptions.DescriptorLayouts);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &_descriptors._layout;
+
+    if (vkCreatePipelineLayout(_gpu->_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+
+    VkPipeline basePipelineHandle = basePipeline ? basePipeline->_pipeline : VK_NULL_HANDLE;
+    _pipeline = Build(_gpu->_device, _options, _target, _pipelineLayout, basePipelineHandle);
+}
+
+VkPipeline Pipeline::Build(VkDevice device, const PipelineOptions& pipelineOptions, const RenderTarget& target,
+    VkPipelineLayout pipelineLayout, VkPipeline basePipeline)
+{
     auto vertShaderCode = ReadFile(pipelineOptions.VertexShader);
-    auto fragShaderCode = ReadFile(pipelineOptions.FragmentShader);
 
-    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode, _gpu->_device);
-    VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode, _gpu->_device);
+    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode, device);
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -203,13 +239,21 @@ void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderPass&
     vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main";
 
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {vertShaderStageInfo};
 
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+    // Without a fragment shader only depth is written, which skips fragment shading entirely.
+    if (!pipelineOptions.FragmentShader.empty())
+    {
+        auto fragShaderCode = ReadFile(pipelineOptions.FragmentShader);
+        fragShaderModule = CreateShaderModule(fragShaderCode, device);
+
+        VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+        fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fragShaderStageInfo.module = fragShaderModule;
+        fragShaderStageInfo.pName = "main";
+        shaderStages.push_back(fragShaderStageInfo);
+    }
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -230,15 +274,15 @@ void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderPass&
         attributeDescriptions.push_back(desc);
     }
 
-    vertexInputInfo.vertexBindingDescriptionCount = 2;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
+    inputAssembly.topology = GetVkPrimitiveTopology(pipelineOptions.Topology);
+    inputAssembly.primitiveRestartEnable = pipelineOptions.EnablePrimitiveRestart ? VK_TRUE : VK_FALSE;
 
     VkPipelineViewportStateCreateInfo viewportState{};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -248,51 +292,34 @@ void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderPass&
     VkPipelineMultisampleStateCreateInfo multisampling{};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 
-    if (renderPass.IsUsingMsaa())
+    multisampling.rasterizationSamples = target.SampleCount;
+
+    if (target.SampleCount != VK_SAMPLE_COUNT_1_BIT && pipelineOptions.EnableSampleShading)
     {
         multisampling.sampleShadingEnable = VK_TRUE;
-        multisampling.minSampleShading = 0.2f;
-        multisampling.rasterizationSamples = renderPass._msaaSampleCount;
+        multisampling.minSampleShading = pipelineOptions.MinSampleShading;
     }
     else
     {
         multisampling.sampleShadingEnable = VK_FALSE;
-        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
     }
 
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthTestEnable = pipelineOptions.EnableDepthTest ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = pipelineOptions.EnableDepthWrite ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = GetVkCompareOp(pipelineOptions.DepthCompareOp);
     depthStencil.depthBoundsTestEnable = VK_FALSE;
     depthStencil.stencilTestEnable = VK_FALSE;
 
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask =
-        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-
-    if (_enableTransparency)
-    {
-        colorBlendAttachment.blendEnable = VK_TRUE;
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-    }
-    else
-    {
-        colorBlendAttachment.blendEnable = VK_FALSE;
-    }
+    auto colorBlendAttachments = CreateColorBlendAttachmentStates(pipelineOptions, target.ColorFormats.size());
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     colorBlending.logicOpEnable = VK_FALSE;
     colorBlending.logicOp = VK_LOGIC_OP_COPY;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
+    colorBlending.attachmentCount = static_cast<uint32_t>(colorBlendAttachments.size());
+    colorBlending.pAttachments = colorBlendAttachments.data();
     colorBlending.blendConstants[0] = 0.0f;
     colorBlending.blendConstants[1] = 0.0f;
     colorBlending.blendConstants[2] = 0.0f;
@@ -304,30 +331,23 @@ void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderPass&
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &_descriptorSetLayout;
-
-    if (vkCreatePipelineLayout(_gpu->_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
-    {
-        throw std::runtime_error("Failed to create pipeline layout!");
-    }
-
     VkPipelineRasterizationStateCreateInfo rasterizer{};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.polygonMode = GetVkPolygonMode(pipelineOptions.PolygonMode);
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
+    rasterizer.cullMode = GetVkCullMode(pipelineOptions.CullMode);
+    rasterizer.frontFace = GetVkFrontFace(pipelineOptions.FrontFace);
+    rasterizer.depthBiasEnable = pipelineOptions.EnableDepthBias ? VK_TRUE : VK_FALSE;
+    rasterizer.depthBiasConstantFactor = pipelineOptions.DepthBiasConstantFactor;
+    rasterizer.depthBiasSlopeFactor = pipelineOptions.DepthBiasSlopeFactor;
+    rasterizer.depthBiasClamp = pipelineOptions.DepthBiasClamp;
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineInfo.pStages = shaderStages.data();
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
@@ -336,28 +356,71 @@ void Pipeline::Create(const PipelineOptions& pipelineOptions, const RenderPass&
     pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = _pipelineLayout;
-    pipelineInfo.renderPass = renderPass._renderPass;
-    pipelineInfo.subpass = 0;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = target.RenderPass;
+    pipelineInfo.subpass = target.Subpass;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    if (pipelineOptions.AllowDerivatives)
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
 
-    if (vkCreateGraphicsPipelines(_gpu->_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS)
+    if (basePipeline != VK_NULL_HANDLE)
+    {
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+        pipelineInfo.basePipelineHandle = basePipeline;
+    }
+
+    // Pipelines used with dynamic rendering are created against their attachment formats instead of a render pass.
+    VkPipelineRenderingCreateInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingInfo.viewMask = target.ViewMask;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(target.ColorFormats.size());
+    renderingInfo.pColorAttachmentFormats = target.ColorFormats.data();
+    renderingInfo.depthAttachmentFormat = target.DepthFormat;
+    renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+    if (target.UseDynamicRendering)
+    {
+        pipelineInfo.pNext = &renderingInfo;
+        pipelineInfo.renderPass = VK_NULL_HANDLE;
+    }
+
+    VkPipeline pipeline;
+    VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
         throw std::runtime_error("Failed to create graphics pipeline!");
 
-    vkDestroyShaderModule(_gpu->_device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(_gpu->_device, vertShaderModule, nullptr);
+    return pipeline;
 }
 
 void Pipeline::Bind()
 {
-    auto currentBufferIndex = _gpu->Commands._currentBufferIndex;
-    vkCmdBindDescriptorSets(_gpu->Commands.GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1,
-        &_descriptorSets[currentBufferIndex], 0, nullptr);
-    vkCmdBindPipeline(_gpu->Commands.GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+    _gpu->Commands.BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, _descriptors.GetCurrentSet());
+    _gpu->Commands.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+}
+
+void Pipeline::Draw(uint32_t vertexCount, uint32_t instanceCount)
+{
+    vkCmdDraw(_gpu->Commands.GetBuffer(), vertexCount, instanceCount, 0, 0);
 }
 
 VkShaderModule Pipeline::CreateShaderModule(const std::vector<char>& code, VkDevice device)
 {
+    // Catches shader files that are empty or still being written, eg. while hot reloading.
+    const uint32_t spirvMagicNumber = 0x07230203;
+    uint32_t magicNumber = 0;
+
+    if (code.size() >= sizeof(magicNumber))
+        std::memcpy(&magicNumber, code.data(), sizeof(magicNumber));
+
+    if (code.size() % sizeof(uint32_t) != 0 || magicNumber != spirvMagicNumber)
+        throw std::runtime_error("Tried to create a shader module from invalid SPIR-V!");
+
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     createInfo.codeSize = code.size();
@@ -386,4 +449,143 @@ VkFormat Pipeline::GetVkFormat(Format format)
             throw std::runtime_error("Tried to get a VkFormat from an invalid format!");
     }
 }
+
+VkPrimitiveTopology Pipeline::GetVkPrimitiveTopology(PrimitiveTopology topology)
+{
+    switch (topology)
+    {
+        case PrimitiveTopology::TriangleList:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        case PrimitiveTopology::TriangleStrip:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        case PrimitiveTopology::TriangleFan:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+        case PrimitiveTopology::LineList:
+            return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case PrimitiveTopology::LineStrip:
+            return VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+        case PrimitiveTopology::PointList:
+            return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        default:
+            throw std::runtime_error("Tried to get a VkPrimitiveTopology from an invalid topology!");
+    }
+}
+
+VkPolygonMode Pipeline::GetVkPolygonMode(RasterMode rasterMode)
+{
+    switch (rasterMode)
+    {
+        case RasterMode::Fill:
+            return VK_POLYGON_MODE_FILL;
+        case RasterMode::Line:
+            return VK_POLYGON_MODE_LINE;
+        case RasterMode::Point:
+            return VK_POLYGON_MODE_POINT;
+        default:
+            throw std::runtime_error("Tried to get a VkPolygonMode from an invalid raster mode!");
+    }
+}
+
+VkCullModeFlags Pipeline::GetVkCullMode(CullFace cullFace)
+{
+    switch (cullFace)
+    {
+        case CullFace::None:
+            return VK_CULL_MODE_NONE;
+        case CullFace::Front:
+            return VK_CULL_MODE_FRONT_BIT;
+        case CullFace::Back:
+            return VK_CULL_MODE_BACK_BIT;
+        case CullFace::FrontAndBack:
+            return VK_CULL_MODE_FRONT_AND_BACK;
+        default:
+            throw std::runtime_error("Tried to get a VkCullModeFlags from an invalid cull face!");
+    }
+}
+
+VkFrontFace Pipeline::GetVkFrontFace(Winding winding)
+{
+    switch (winding)
+    {
+        case Winding::CounterClockwise:
+            return VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        case Winding::Clockwise:
+            return VK_FRONT_FACE_CLOCKWISE;
+        default:
+            throw std::runtime_error("Tried to get a VkFrontFace from an invalid winding!");
+    }
+}
+
+VkCompareOp Pipeline::GetVkCompareOp(CompareOp compareOp)
+{
+    switch (compareOp)
+    {
+        case CompareOp::Never:
+            return VK_COMPARE_OP_NEVER;
+        case CompareOp::Less:
+            return VK_COMPARE_OP_LESS;
+        case CompareOp::Equal:
+            return VK_COMPARE_OP_EQUAL;
+        case CompareOp::LessOrEqual:
+            return VK_COMPARE_OP_LESS_OR_EQUAL;
+        case CompareOp::Greater:
+            return VK_COMPARE_OP_GREATER;
+        case CompareOp::NotEqual:
+            return VK_COMPARE_OP_NOT_EQUAL;
+        case CompareOp::GreaterOrEqual:
+            return VK_COMPARE_OP_GREATER_OR_EQUAL;
+        case CompareOp::Always:
+            return VK_COMPARE_OP_ALWAYS;
+        default:
+            throw std::runtime_error("Tried to get a VkCompareOp from an invalid compare op!");
+    }
+}
+
+VkBlendFactor Pipeline::GetVkBlendFactor(BlendFactor blendFactor)
+{
+    switch (blendFactor)
+    {
+        case BlendFactor::Zero:
+            return VK_BLEND_FACTOR_ZERO;
+        case BlendFactor::One:
+            return VK_BLEND_FACTOR_ONE;
+        case BlendFactor::SrcColor:
+            return VK_BLEND_FACTOR_SRC_COLOR;
+        case BlendFactor::OneMinusSrcColor:
+            return VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+        case BlendFactor::DstColor:
+            return VK_BLEND_FACTOR_DST_COLOR;
+        case BlendFactor::OneMinusDstColor:
+            return VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+        case BlendFactor::SrcAlpha:
+            return VK_BLEND_FACTOR_SRC_ALPHA;
+        case BlendFactor::OneMinusSrcAlpha:
+            return VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        case BlendFactor::DstAlpha:
+            return VK_BLEND_FACTOR_DST_ALPHA;
+        case BlendFactor::OneMinusDstAlpha:
+            return VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA;
+        default:
+            throw std::runtime_error("Tried to get a VkBlendFactor from an invalid blend factor!");
+    }
+}
+
+VkBlendOp Pipeline::GetVkBlendOp(BlendOp blendOp)
+{
+    switch (blendOp)
+    {
+        case BlendOp::Add:
+            return VK_BLEND_OP_ADD;
+        case BlendOp::Subtract:
+            return VK_BLEND_OP_SUBTRACT;
+        case BlendOp::ReverseSubtract:
+            return VK_BLEND_OP_REVERSE_SUBTRACT;
+        case BlendOp::Min:
+            return VK_BLEND_OP_MIN;
+        case BlendOp::Max:
+            return VK_BLEND_OP_MAX;
+        default:
+            throw std::runtime_error("Tried to get a VkBlendOp from an invalid blend op!");
+    }
+}
 } // namespace GpuVk
\ No newline at end of file
@@ -9,8 +9,10 @@
 #include <vector>
 
 #include "Constants.hpp"
+#include "Descriptors.hpp"
 #include "Gpu.hpp"
 #include "PipelineOptions.hpp"
+#include "RenderGraph.hpp"
 #include "RenderPass.hpp"
 #include "Sampler.hpp"
 #include "Swapchain.hpp"
@@ -20,63 +22,82 @@ namespace GpuVk
 {
 class Pipeline
 {
+    friend class ComputePipeline;
+    friend class ShaderHotReload;
+    friend class Sampler;
+
     public:
     Pipeline() = default;
     Pipeline(std::shared_ptr<Gpu> gpu, const PipelineOptions& pipelineOptions, const RenderPass& renderPass);
+    // Creates a derivative of a pipeline that was created with AllowDerivatives enabled.
+    Pipeline(std::shared_ptr<Gpu> gpu, const PipelineOptions& pipelineOptions, const RenderPass& renderPass,
+        const Pipeline& basePipeline);
+    // Creates a pipeline that renders to the attachments a render graph pass writes to.
+    Pipeline(std::shared_ptr<Gpu> gpu, const PipelineOptions& pipelineOptions, const RenderGraph& renderGraph,
+        RenderGraphPass pass);
     Pipeline(Pipeline&& other);
     Pipeline& operator=(Pipeline&& other);
     ~Pipeline();
 
     template <typename T> void UpdateUniform(uint32_t binding, const UniformBuffer<T>& uniformBuffer)
     {
-        for (uint32_t i = 0; i < MaxFramesInFlight; i++)
-        {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = uniformBuffer.GetBuffer(i);
-            bufferInfo.offset = 0;
-            bufferInfo.range = uniformBuffer.GetDataSize();
-
-            VkWriteDescriptorSet descriptorWrite{};
-            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrite.dstSet = _descriptorSets[i];
-            descriptorWrite.dstBinding = binding;
-            descriptorWrite.dstArrayElement = 0;
-            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrite.descriptorCount = 1;
-            descriptorWrite.pBufferInfo = &bufferInfo;
-
-            vkUpdateDescriptorSets(_gpu->_device, 1, &descriptorWrite, 0, nullptr);
-        }
+        _descriptors.UpdateUniform(binding, uniformBuffer);
     }
 
     void UpdateImage(uint32_t binding, const Image& image, const Sampler& sampler);
+    void UpdateStorageBuffer(uint32_t binding, const Buffer& buffer);
+    void UpdateStorageImage(uint32_t binding, const Image& image);
+    void UpdateInputAttachment(uint32_t binding, const Image& image);
 
     void Bind();
+    // Draws without vertex buffers, eg. a fullscreen triangle made from gl_VertexIndex for a final pass that
+    // tonemaps an HDR render pass's color image to the swapchain.
+    void Draw(uint32_t vertexCount, uint32_t instanceCount = 1);
 
     private:
-    static VkDescriptorType GetVkDescriptorType(DescriptorType descriptorType);
-    void CreateDescriptorSetLayout();
-    void CreateDescriptorPool();
-    void CreateDescriptorSets();
-    std::array<VkVertexInputBindingDescription, 2> CreateVertexInputBindingDescriptions(
+    // What the pipeline needs to know about the render pass it was created for, kept so that it can be rebuilt.
+    struct RenderTarget
+    {
+        VkRenderPass RenderPass = VK_NULL_HANDLE;
+        bool UseDynamicRendering = false;
+        std::vector<VkFormat> ColorFormats;
+        VkFormat DepthFormat = VK_FORMAT_UNDEFINED;
+        VkSampleCountFlagBits SampleCount = VK_SAMPLE_COUNT_1_BIT;
+        uint32_t Subpass = 0;
+        uint32_t ViewMask = 0;
+    };
+
+    // Vertex and instance data without a size or attributes are left out, eg. for a fullscreen triangle.
+    static std::vector<VkVertexInputBindingDescription> CreateVertexInputBindingDescriptions(
         const PipelineOptions& pipelineOptions);
-    std::vector<VkVertexInputAttributeDescription> CreateVertexInputAttributeDescriptions(
+    static std::vector<VkVertexInputAttributeDescription> CreateVertexInputAttributeDescriptions(
         const VertexOptions& vertexOptions);
-    void Create(const PipelineOptions& pipelineOptions, const RenderPass& renderPass);
+    static std::vector<VkPipelineColorBlendAttachmentState> CreateColorBlendAttachmentStates(
+        const PipelineOptions& pipelineOptions, size_t colorAttachmentCount);
+    static RenderTarget GetRenderTarget(const RenderPass& renderPass, uint32_t subpass);
+    void Create(const PipelineOptions& pipelineOptions, const RenderTarget& target, const Pipeline* basePipeline);
+    // Only touches the device, so it can be called from a background thread to rebuild a pipeline.
+    static VkPipeline Build(VkDevice device, const PipelineOptions& pipelineOptions, const RenderTarget& target,
+        VkPipelineLayout pipelineLayout, VkPipeline basePipeline);
 
     static VkShaderModule CreateShaderModule(const std::vector<char>& code, VkDevice device);
     static VkFormat GetVkFormat(Format format);
+    static VkPrimitiveTopology GetVkPrimitiveTopology(PrimitiveTopology topology);
+    static VkPolygonMode GetVkPolygonMode(RasterMode rasterMode);
+    static VkCullModeFlags GetVkCullMode(CullFace cullFace);
+    static VkFrontFace GetVkFrontFace(Winding winding);
+    static VkCompareOp GetVkCompareOp(CompareOp compareOp);
+    static VkBlendFactor GetVkBlendFactor(BlendFactor blendFactor);
+    static VkBlendOp GetVkBlendOp(BlendOp blendOp);
 
     std::shared_ptr<Gpu> _gpu;
 
     VkPipelineLayout _pipelineLayout;
     VkPipeline _pipeline;
 
-    VkDescriptorSetLayout _descriptorSetLayout;
-    VkDescriptorPool _descriptorPool;
-    std::vector<VkDescriptorSet> _descriptorSets;
-    std::vector<DescriptorLayout> _descriptorLayouts;
+    Descriptors _descriptors;
 
-    bool _enableTransparency = false;
+    PipelineOptions _options;
+    RenderTarget _target;
 };
 } // namespace GpuVk
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 
+#include "CompareOp.hpp"
 #include "Format.hpp"
 
 namespace GpuVk
@@ -25,13 +26,18 @@ struct VertexOptions
 enum class DescriptorType
 {
     UniformBuffer,
-    ImageSampler
+    ImageSampler,
+    StorageBuffer,
+    StorageImage,
+    // Reads the render pass attachment at the same pixel, only from fragment shaders.
+    InputAttachment
 };
 
 enum class ShaderStage
 {
     Vertex,
-    Fragment
+    Fragment,
+    Compute
 };
 
 struct DescriptorLayout
@@ -41,13 +47,118 @@ struct DescriptorLayout
     ShaderStage ShaderStage;
 };
 
+enum class PrimitiveTopology
+{
+    TriangleList,
+    TriangleStrip,
+    TriangleFan,
+    LineList,
+    LineStrip,
+    PointList
+};
+
+enum class CullFace
+{
+    None,
+    Front,
+    Back,
+    FrontAndBack
+};
+
+enum class Winding
+{
+    CounterClockwise,
+    Clockwise
+};
+
+enum class RasterMode
+{
+    Fill,
+    Line,
+    Point
+};
+
+enum class BlendFactor
+{
+    Zero,
+    One,
+    SrcColor,
+    OneMinusSrcColor,
+    DstColor,
+    OneMinusDstColor,
+    SrcAlpha,
+    OneMinusSrcAlpha,
+    DstAlpha,
+    OneMinusDstAlpha
+};
+
+enum class BlendOp
+{
+    Add,
+    Subtract,
+    ReverseSubtract,
+    Min,
+    Max
+};
+
+struct BlendOptions
+{
+    bool EnableBlending = false;
+    BlendFactor SrcColorFactor = BlendFactor::SrcAlpha;
+    BlendFactor DstColorFactor = BlendFactor::OneMinusSrcAlpha;
+    BlendOp ColorOp = BlendOp::Add;
+    BlendFactor SrcAlphaFactor = BlendFactor::One;
+    BlendFactor DstAlphaFactor = BlendFactor::Zero;
+    BlendOp AlphaOp = BlendOp::Add;
+    bool EnableColorWrites = true;
+};
+
 struct PipelineOptions
 {
     std::string VertexShader;
+    // Can be left empty for pipelines that only write depth, eg. for a depth pre-pass or a shadow map.
     std::string FragmentShader;
     bool EnableTransparency;
     VertexOptions VertexDataOptions;
     VertexOptions InstanceDataOptions;
     std::vector<DescriptorLayout> DescriptorLayouts;
+
+    PrimitiveTopology Topology = PrimitiveTopology::TriangleList;
+    // Only valid for strip and fan topologies, an index of all ones starts a new primitive.
+    bool EnablePrimitiveRestart = false;
+    RasterMode PolygonMode = RasterMode::Fill;
+    CullFace CullMode = CullFace::Back;
+    Winding FrontFace = Winding::CounterClockwise;
+
+    bool EnableDepthTest = true;
+    bool EnableDepthWrite = true;
+    CompareOp DepthCompareOp = CompareOp::Less;
+    bool EnableDepthBias = false;
+    float DepthBiasConstantFactor = 0.0f;
+    float DepthBiasSlopeFactor = 0.0f;
+    // Clamping to anything but 0 needs a GPU that supports it.
+    float DepthBiasClamp = 0.0f;
+
+    // One entry per color attachment, when empty EnableTransparency picks between no blending and alpha blending.
+    std::vector<BlendOptions> ColorBlending;
+
+    // Shades more than once per pixel when multisampling, at least the given fraction of the samples each time.
+    // Smooths aliasing inside of triangles, eg. from alpha tested textures, at a multiple of the fragment cost.
+    bool EnableSampleShading = false;
+    float MinSampleShading = 0.2f;
+
+    // Allows other pipelines to be created as derivatives of this one.
+    bool AllowDerivatives = false;
+
+    // The subpass of the render pass that the pipeline is used in.
+    uint32_t Subpass = 0;
+};
+
+struct ComputePipelineOptions
+{
+    std::string ComputeShader;
+    std::vector<DescriptorLayout> DescriptorLayouts;
+    // Record barriers around each dispatch, can be disabled when a RenderGraph records them instead.
+    bool EnableAutomaticBarriers = true;
 };
-}
\ No newline at end of file
+} // namespace GpuVk
\ No newline at end of file
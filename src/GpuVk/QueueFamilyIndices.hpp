@@ -25,7 +25,8 @@ class QueueFamilyIndices
         int i = 0;
         for (const auto& queueFamily : queueFamilies)
         {
-            if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            // Compute work is recorded into the same command buffers as graphics work, so one family must do both.
+            if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT))
                 _graphicsFamily = i;
 
             VkBool32 presentSupport = false;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+
+namespace GpuVk
+{
+// Selects part of an image to read back, a width or height of 0 reads to the edge of the mip level.
+struct ReadbackOptions
+{
+    uint32_t MipmapLevel = 0;
+    uint32_t Layer = 0;
+    uint32_t X = 0;
+    uint32_t Y = 0;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+};
+
+// Receives tightly packed texels, which are only valid until the callback returns.
+using ReadbackCallback = std::function<void(const uint8_t* texels, uint32_t width, uint32_t height)>;
+} // namespace GpuVk
\ No newline at end of file
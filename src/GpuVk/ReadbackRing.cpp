@@ -0,0 +1,46 @@
+#include "ReadbackRing.hpp"
+
+namespace GpuVk
+{
+ReadbackRing::ReadbackRing(std::shared_ptr<Gpu> gpu) : _gpu(gpu), _freeBuffers(std::make_shared<std::vector<Buffer>>())
+{
+}
+
+ReadbackRing::ReadbackRing(ReadbackRing&& other)
+{
+    *this = std::move(other);
+}
+
+ReadbackRing& ReadbackRing::operator=(ReadbackRing&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_freeBuffers, other._freeBuffers);
+
+    return *this;
+}
+
+std::shared_ptr<Buffer> ReadbackRing::Acquire(size_t byteSize)
+{
+    if (!_gpu)
+        throw std::runtime_error("Tried to read back an image without initializing the readback ring!");
+
+    // The smallest free buffer that fits is reused, so reading back different sizes doesn't grow every buffer.
+    auto bestBuffer = _freeBuffers->end();
+
+    for (auto buffer = _freeBuffers->begin(); buffer != _freeBuffers->end(); buffer++)
+    {
+        if (buffer->GetSize() >= byteSize && (bestBuffer == _freeBuffers->end() ||
+                                                 buffer->GetSize() < bestBuffer->GetSize()))
+            bestBuffer = buffer;
+    }
+
+    if (bestBuffer == _freeBuffers->end())
+        return std::make_shared<Buffer>(Buffer(_gpu, byteSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, true));
+
+    auto buffer = std::make_shared<Buffer>(std::move(*bestBuffer));
+    _freeBuffers->erase(bestBuffer);
+
+    return buffer;
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "Gpu.hpp"
+
+namespace GpuVk
+{
+// Host visible buffers that images are read back into. A buffer is reused once its readback has completed, so
+// reading back every frame settles on one buffer per frame in flight.
+class ReadbackRing
+{
+    friend class Image;
+
+    public:
+    ReadbackRing() = default;
+    ReadbackRing(std::shared_ptr<Gpu> gpu);
+    ReadbackRing(ReadbackRing&& other);
+    ReadbackRing& operator=(ReadbackRing&& other);
+
+    private:
+    std::shared_ptr<Buffer> Acquire(size_t byteSize);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    // Shared with the readbacks in flight, which return their buffer when they complete if the ring still exists.
+    std::shared_ptr<std::vector<Buffer>> _freeBuffers;
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -25,6 +25,7 @@ void RenderEngine::InitVulkan(PresentMode preferredPresentMode, const uint32_t w
 
     _gpu->Swapchain = Swapchain(_gpu, windowWidth, windowHeight, preferredPresentMode);
     _gpu->Commands = Commands(_gpu);
+    _gpu->_stagingRing = StagingRing(_gpu);
 }
 
 void RenderEngine::MainLoop(IRenderer& renderer)
@@ -84,6 +85,7 @@ void RenderEngine::Cleanup()
 void RenderEngine::DrawFrame(IRenderer& renderer)
 {
     vkWaitForFences(_gpu->_device, 1, &_gpu->GetCurrentInFlightFence(), VK_TRUE, UINT64_MAX);
+    _gpu->DestroyRetired();
 
     auto result = _gpu->Swapchain.GetNextImage();
 
@@ -0,0 +1,1195 @@
+#include "RenderGraph.hpp"
+
+#include <algorithm>
+#include <set>
+
+namespace GpuVk
+{
+const VkPipelineStageFlags ShaderStages =
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+const VkAccessFlags WriteAccessFlags = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+                                       VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+RenderGraph::RenderGraph(std::shared_ptr<Gpu> gpu) : _gpu(gpu)
+{
+}
+
+RenderGraph::RenderGraph(RenderGraph&& other)
+{
+    *this = std::move(other);
+}
+
+RenderGraph& RenderGraph::operator=(RenderGraph&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_imageResources, other._imageResources);
+    std::swap(_bufferResources, other._bufferResources);
+    std::swap(_passes, other._passes);
+
+    std::swap(_isCompiled, other._isCompiled);
+    std::swap(_executionOrder, other._executionOrder);
+    std::swap(_finalBarriers, other._finalBarriers);
+
+    std::swap(_transientImages, other._transientImages);
+    std::swap(_transientVkImages, other._transientVkImages);
+    std::swap(_transientMemory, other._transientMemory);
+
+    std::swap(_vkImageBarriers, other._vkImageBarriers);
+    std::swap(_vkBufferBarriers, other._vkBufferBarriers);
+
+    return *this;
+}
+
+RenderGraph::~RenderGraph()
+{
+    if (!_gpu)
+        return;
+
+    DestroyTransientImages();
+}
+
+RenderGraphImage RenderGraph::ImportImage(const Image& image)
+{
+    ImageResource resource{};
+    resource.Imported = &image;
+    resource.Format = image._format;
+
+    _imageResources.push_back(resource);
+    _isCompiled = false;
+
+    return RenderGraphImage{static_cast<uint32_t>(_imageResources.size() - 1)};
+}
+
+RenderGraphBuffer RenderGraph::ImportBuffer(const Buffer& buffer)
+{
+    BufferResource resource{};
+    resource.Imported = &buffer;
+
+    _bufferResources.push_back(resource);
+    _isCompiled = false;
+
+    return RenderGraphBuffer{static_cast<uint32_t>(_bufferResources.size() - 1)};
+}
+
+RenderGraphImage RenderGraph::CreateImage(const TransientImageOptions& options)
+{
+    if ((options.Width == 0) != (options.Height == 0))
+        throw std::runtime_error("Tried to create a transient image with only one of its width and height!");
+
+    if (options.Scale <= 0.0f)
+        throw std::runtime_error("Tried to create a transient image with a scale that isn't positive!");
+
+    ImageResource resource{};
+    resource.Options = options;
+    resource.Format = options.IsDepth ? _gpu->FindDepthFormat() : Image::GetVkFormat(options.Format);
+
+    _imageResources.push_back(resource);
+    _isCompiled = false;
+
+    return RenderGraphImage{static_cast<uint32_t>(_imageResources.size() - 1)};
+}
+
+RenderGraphPass RenderGraph::AddPass(const std::string& name, std::function<void()> record)
+{
+    Pass pass{};
+    pass.Name = name;
+    pass.Record = std::move(record);
+
+    _passes.push_back(std::move(pass));
+    _isCompiled = false;
+
+    return RenderGraphPass{static_cast<uint32_t>(_passes.size() - 1)};
+}
+
+void RenderGraph::Read(RenderGraphPass pass, RenderGraphImage image, ImageAccess access)
+{
+    if (access == ImageAccess::ColorAttachment)
+        throw std::runtime_error("Tried to read from a color attachment, color attachments can only be written!");
+
+    AddImageUse(pass, image, access, false);
+}
+
+void RenderGraph::Write(RenderGraphPass pass, RenderGraphImage image, ImageAccess access)
+{
+    if (access == ImageAccess::Sampled)
+        throw std::runtime_error("Tried to write to a sampled image, sampled images can only be read!");
+
+    AddImageUse(pass, image, access, true);
+}
+
+void RenderGraph::Read(RenderGraphPass pass, RenderGraphBuffer buffer, BufferAccess access)
+{
+    AddBufferUse(pass, buffer, access, false);
+}
+
+void RenderGraph::Write(RenderGraphPass pass, RenderGraphBuffer buffer, BufferAccess access)
+{
+    if (access != BufferAccess::Storage && access != BufferAccess::Transfer)
+        throw std::runtime_error("Tried to write to a buffer with an access that can only read!");
+
+    AddBufferUse(pass, buffer, access, true);
+}
+
+void RenderGraph::SetClearColor(RenderGraphPass pass, const ClearColor& clearColor)
+{
+    Pass& graphPass = GetPass(pass);
+    graphPass.HasClearColor = true;
+    graphPass.ClearValue = clearColor;
+}
+
+void RenderGraph::MarkOutput(RenderGraphImage image)
+{
+    if (image.Id >= _imageResources.size())
+        throw std::runtime_error("Tried to mark an invalid image as a render graph output!");
+
+    _imageResources[image.Id].IsOutput = true;
+    _isCompiled = false;
+}
+
+void RenderGraph::MarkOutput(RenderGraphBuffer buffer)
+{
+    if (buffer.Id >= _bufferResources.size())
+        throw std::runtime_error("Tried to mark an invalid buffer as a render graph output!");
+
+    _bufferResources[buffer.Id].IsOutput = true;
+    _isCompiled = false;
+}
+
+void RenderGraph::KeepPass(RenderGraphPass pass)
+{
+    GetPass(pass).IsKept = true;
+    _isCompiled = false;
+}
+
+void RenderGraph::Compile()
+{
+    DestroyTransientImages();
+
+    FindDependencies();
+    CullPasses();
+    SortPasses();
+    FindImageLifetimes();
+
+    for (uint32_t passIndex : _executionOrder)
+    {
+        const Pass& pass = _passes[passIndex];
+        bool hasAttachments = !GetColorAttachments(pass).empty() || GetDepthAttachment(pass);
+
+        if (hasAttachments && !_gpu->SupportsDynamicRendering())
+            throw std::runtime_error("Tried to compile a render graph with attachments without dynamic rendering!");
+    }
+
+    CreateTransientImages();
+    CreateBarriers();
+
+    _isCompiled = true;
+}
+
+void RenderGraph::Execute()
+{
+    if (!_isCompiled)
+        throw std::runtime_error("Tried to execute a render graph that hasn't been compiled!");
+
+    auto commandBuffer = _gpu->Commands.GetBuffer();
+
+    for (uint32_t passIndex : _executionOrder)
+    {
+        const Pass& pass = _passes[passIndex];
+        bool hasAttachments = !GetColorAttachments(pass).empty() || GetDepthAttachment(pass);
+
+        RecordBarriers(commandBuffer, pass.Barriers);
+
+        if (hasAttachments)
+            BeginRendering(commandBuffer, pass);
+
+        _gpu->Commands._isInRenderPass = hasAttachments;
+        pass.Record();
+        _gpu->Commands._isInRenderPass = false;
+
+        if (hasAttachments)
+            _gpu->_vkCmdEndRenderingKHR(commandBuffer);
+    }
+
+    RecordBarriers(commandBuffer, _finalBarriers);
+}
+
+const Image& RenderGraph::GetImage(RenderGraphImage image) const
+{
+    if (image.Id >= _imageResources.size())
+        throw std::runtime_error("Tried to get an invalid render graph image!");
+
+    const ImageResource& resource = _imageResources[image.Id];
+
+    if (resource.Imported)
+        return *resource.Imported;
+
+    if (!_isCompiled || !resource.IsUsed)
+        throw std::runtime_error("Tried to get a transient image that hasn't been created!");
+
+    return _transientImages[image.Id];
+}
+
+bool RenderGraph::IsPassCulled(RenderGraphPass pass) const
+{
+    return GetPass(pass).IsCulled;
+}
+
+VkDeviceSize RenderGraph::GetTransientMemorySize() const
+{
+    VkDeviceSize size = 0;
+
+    for (const auto& memory : _transientMemory)
+        size += memory.Requirements.size;
+
+    return size;
+}
+
+RenderGraph::Pass& RenderGraph::GetPass(RenderGraphPass pass)
+{
+    if (pass.Id >= _passes.size())
+        throw std::runtime_error("Tried to get an invalid render graph pass!");
+
+    return _passes[pass.Id];
+}
+
+const RenderGraph::Pass& RenderGraph::GetPass(RenderGraphPass pass) const
+{
+    if (pass.Id >= _passes.size())
+        throw std::runtime_error("Tried to get an invalid render graph pass!");
+
+    return _passes[pass.Id];
+}
+
+void RenderGraph::AddImageUse(RenderGraphPass pass, RenderGraphImage image, ImageAccess access, bool isWrite)
+{
+    if (image.Id >= _imageResources.size())
+        throw std::runtime_error("Tried to use an invalid image in a render graph pass!");
+
+    const ImageResource& resource = _imageResources[image.Id];
+
+    if (access == ImageAccess::Storage && resource.Imported && resource.Imported->_layout != VK_IMAGE_LAYOUT_GENERAL)
+        throw std::runtime_error("Tried to use an image that wasn't created for storage as a storage image!");
+
+    GetPass(pass).ImageUses.push_back(ImageUse{image.Id, access, isWrite});
+    _isCompiled = false;
+}
+
+void RenderGraph::AddBufferUse(RenderGraphPass pass, RenderGraphBuffer buffer, BufferAccess access, bool isWrite)
+{
+    if (buffer.Id >= _bufferResources.size())
+        throw std::runtime_error("Tried to use an invalid buffer in a render graph pass!");
+
+    GetPass(pass).BufferUses.push_back(BufferUse{buffer.Id, access, isWrite});
+    _isCompiled = false;
+}
+
+void RenderGraph::FindDependencies()
+{
+    std::vector<std::vector<ResourceAccess>> imageAccesses(_imageResources.size());
+    std::vector<std::vector<ResourceAccess>> bufferAccesses(_bufferResources.size());
+
+    auto addAccess = [](std::vector<ResourceAccess>& accesses, uint32_t pass, bool isWrite) {
+        if (accesses.empty() || accesses.back().Pass != pass)
+            accesses.push_back(ResourceAccess{pass, false, false});
+
+        accesses.back().IsRead = accesses.back().IsRead || !isWrite;
+        accesses.back().IsWrite = accesses.back().IsWrite || isWrite;
+    };
+
+    for (uint32_t i = 0; i < _passes.size(); i++)
+    {
+        _passes[i].Producers.clear();
+        _passes[i].Dependencies.clear();
+
+        for (const auto& use : _passes[i].ImageUses)
+            addAccess(imageAccesses[use.Image], i, use.IsWrite);
+
+        for (const auto& use : _passes[i].BufferUses)
+            addAccess(bufferAccesses[use.Buffer], i, use.IsWrite);
+    }
+
+    for (size_t i = 0; i < _imageResources.size(); i++)
+        AddDependencies(imageAccesses[i], !_imageResources[i].Imported);
+
+    for (const auto& accesses : bufferAccesses)
+        AddDependencies(accesses, false);
+}
+
+void RenderGraph::AddDependencies(const std::vector<ResourceAccess>& accesses, bool isTransient)
+{
+    auto addDependency = [this](uint32_t pass, uint32_t dependency, bool isProducer) {
+        if (pass == dependency)
+            return;
+
+        _passes[pass].Dependencies.push_back(dependency);
+
+        if (isProducer)
+            _passes[pass].Producers.push_back(dependency);
+    };
+
+    auto firstWrite = std::find_if(
+        accesses.begin(), accesses.end(), [](const ResourceAccess& access) { return access.IsWrite; });
+    bool hasWriter = false;
+    uint32_t lastWriter = 0;
+    // Passes that read the last write, which have to run before it's overwritten.
+    std::vector<uint32_t> readers;
+    // Reads of a transient image from before its first write, which read that write instead.
+    std::vector<uint32_t> earlyReaders;
+
+    for (const auto& access : accesses)
+    {
+        if (!access.IsWrite)
+        {
+            if (hasWriter)
+            {
+                addDependency(access.Pass, lastWriter, true);
+                readers.push_back(access.Pass);
+            }
+            else if (isTransient && firstWrite != accesses.end())
+            {
+                addDependency(access.Pass, firstWrite->Pass, true);
+                earlyReaders.push_back(access.Pass);
+            }
+            else
+            {
+                // Imported resources are read with the contents they had before the frame.
+                readers.push_back(access.Pass);
+            }
+
+            continue;
+        }
+
+        if (hasWriter)
+            addDependency(access.Pass, lastWriter, true);
+
+        for (uint32_t reader : readers)
+            addDependency(access.Pass, reader, false);
+
+        hasWriter = true;
+        lastWriter = access.Pass;
+        readers.clear();
+
+        if (!earlyReaders.empty())
+            readers = std::move(earlyReaders);
+
+        earlyReaders.clear();
+    }
+}
+
+void RenderGraph::CullPasses()
+{
+    // A pass is needed if it's kept or writes an output, or if a needed pass depends on what it writes.
+    std::vector<uint32_t> needed;
+
+    for (uint32_t i = 0; i < _passes.size(); i++)
+    {
+        Pass& pass = _passes[i];
+        bool isNeeded = pass.IsKept;
+
+        for (const auto& use : pass.ImageUses)
+            isNeeded = isNeeded || (use.IsWrite && _imageResources[use.Image].IsOutput);
+
+        for (const auto& use : pass.BufferUses)
+            isNeeded = isNeeded || (use.IsWrite && _bufferResources[use.Buffer].IsOutput);
+
+        pass.IsCulled = !isNeeded;
+
+        if (isNeeded)
+            needed.push_back(i);
+    }
+
+    while (!needed.empty())
+    {
+        uint32_t passIndex = needed.back();
+        needed.pop_back();
+
+        for (uint32_t producer : _passes[passIndex].Producers)
+        {
+            if (!_passes[producer].IsCulled)
+                continue;
+
+            _passes[producer].IsCulled = false;
+            needed.push_back(producer);
+        }
+    }
+}
+
+void RenderGraph::SortPasses()
+{
+    // Of the passes whose dependencies have run, the one that was added first runs next.
+    std::vector<uint32_t> remainingDependencies(_passes.size(), 0);
+    std::vector<std::vector<uint32_t>> dependents(_passes.size());
+
+    for (uint32_t i = 0; i < _passes.size(); i++)
+    {
+        if (_passes[i].IsCulled)
+            continue;
+
+        for (uint32_t dependency : _passes[i].Dependencies)
+        {
+            if (_passes[dependency].IsCulled)
+                continue;
+
+            remainingDependencies[i]++;
+            dependents[dependency].push_back(i);
+        }
+    }
+
+    std::set<uint32_t> ready;
+    size_t passCount = 0;
+
+    for (uint32_t i = 0; i < _passes.size(); i++)
+    {
+        if (_passes[i].IsCulled)
+            continue;
+
+        passCount++;
+
+        if (remainingDependencies[i] == 0)
+            ready.insert(i);
+    }
+
+    _executionOrder.clear();
+
+    while (!ready.empty())
+    {
+        uint32_t passIndex = *ready.begin();
+        ready.erase(ready.begin());
+
+        _passes[passIndex].Position = static_cast<uint32_t>(_executionOrder.size());
+        _executionOrder.push_back(passIndex);
+
+        for (uint32_t dependent : dependents[passIndex])
+        {
+            if (--remainingDependencies[dependent] == 0)
+                ready.insert(dependent);
+        }
+    }
+
+    if (_executionOrder.size() != passCount)
+        throw std::runtime_error("Tried to compile a render graph with passes that depend on each other in a cycle!");
+}
+
+void RenderGraph::FindImageLifetimes()
+{
+    for (auto& resource : _imageResources)
+    {
+        resource.Usage = 0;
+        resource.IsUsed = false;
+        resource.UsesStorage = false;
+    }
+
+    for (uint32_t passIndex : _executionOrder)
+    {
+        const Pass& pass = _passes[passIndex];
+
+        for (const auto& use : pass.ImageUses)
+        {
+            ImageResource& resource = _imageResources[use.Image];
+
+            if (!resource.IsUsed)
+            {
+                if (!resource.Imported && !use.IsWrite)
+                {
+                    throw std::runtime_error(
+                        "Tried to read a transient image in pass \"" + pass.Name + "\" before it was written!");
+                }
+
+                resource.IsUsed = true;
+                resource.FirstUse = pass.Position;
+            }
+
+            resource.LastUse = pass.Position;
+            resource.Usage |= GetImageUsage(use.Access, use.IsWrite);
+            resource.UsesStorage = resource.UsesStorage || use.Access == ImageAccess::Storage;
+        }
+    }
+}
+
+void RenderGraph::CreateTransientImages()
+{
+    _transientImages.resize(_imageResources.size());
+    _transientVkImages.assign(_imageResources.size(), VK_NULL_HANDLE);
+
+    std::vector<uint32_t> transientImages;
+    std::vector<VkMemoryRequirements> requirements(_imageResources.size());
+
+    for (uint32_t i = 0; i < _imageResources.size(); i++)
+    {
+        ImageResource& resource = _imageResources[i];
+
+        if (resource.Imported || !resource.IsUsed)
+            continue;
+
+        VkExtent2D extent = GetTransientExtent(resource);
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = extent.width;
+        imageInfo.extent.height = extent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = resource.Format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = resource.Usage;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(_gpu->_device, &imageInfo, nullptr, &_transientVkImages[i]) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create transient image!");
+
+        vkGetImageMemoryRequirements(_gpu->_device, _transientVkImages[i], &requirements[i]);
+        transientImages.push_back(i);
+    }
+
+    // Place the largest images first, then let smaller ones share memory with any image whose lifetime they
+    // don't overlap. Their contents are discarded each time the memory changes hands.
+    std::sort(transientImages.begin(), transientImages.end(),
+        [&requirements](uint32_t a, uint32_t b) { return requirements[a].size > requirements[b].size; });
+
+    for (uint32_t image : transientImages)
+    {
+        ImageResource& resource = _imageResources[image];
+        const VkMemoryRequirements& imageRequirements = requirements[image];
+        bool hasMemory = false;
+
+        for (uint32_t memoryIndex = 0; memoryIndex < _transientMemory.size() && !hasMemory; memoryIndex++)
+        {
+            TransientMemory& memory = _transientMemory[memoryIndex];
+
+            if (!(memory.Requirements.memoryTypeBits & imageRequirements.memoryTypeBits))
+                continue;
+
+            bool isOverlapping = false;
+
+            for (uint32_t other : memory.Images)
+            {
+                const ImageResource& otherResource = _imageResources[other];
+                isOverlapping = isOverlapping || (resource.FirstUse <= otherResource.LastUse &&
+                                                     otherResource.FirstUse <= resource.LastUse);
+            }
+
+            if (isOverlapping)
+                continue;
+
+            memory.Requirements.size = std::max(memory.Requirements.size, imageRequirements.size);
+            memory.Requirements.alignment = std::max(memory.Requirements.alignment, imageRequirements.alignment);
+            memory.Requirements.memoryTypeBits &= imageRequirements.memoryTypeBits;
+            memory.Images.push_back(image);
+            resource.MemoryIndex = memoryIndex;
+            hasMemory = true;
+        }
+
+        if (hasMemory)
+            continue;
+
+        TransientMemory memory{};
+        memory.Requirements = imageRequirements;
+        memory.Images.push_back(image);
+        resource.MemoryIndex = static_cast<uint32_t>(_transientMemory.size());
+        _transientMemory.push_back(memory);
+    }
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    for (auto& memory : _transientMemory)
+    {
+        if (vmaAllocateMemory(_gpu->_allocator, &memory.Requirements, &allocationInfo, &memory.Allocation, nullptr) !=
+            VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate transient image memory!");
+
+        for (uint32_t image : memory.Images)
+        {
+            if (vmaBindImageMemory(_gpu->_allocator, memory.Allocation, _transientVkImages[image]) != VK_SUCCESS)
+                throw std::runtime_error("Failed to bind transient image memory!");
+        }
+    }
+
+    for (uint32_t image : transientImages)
+    {
+        const ImageResource& resource = _imageResources[image];
+        VkImageAspectFlags aspectFlags =
+            resource.Options.IsDepth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+
+        Image transientImage(_gpu, _transientVkImages[image], resource.Format, aspectFlags);
+        transientImage._width = GetTransientExtent(resource).width;
+        transientImage._height = GetTransientExtent(resource).height;
+        transientImage._layout = GetShaderReadLayout(image);
+        transientImage._usage = resource.Usage;
+
+        _transientImages[image] = std::move(transientImage);
+    }
+}
+
+void RenderGraph::DestroyTransientImages()
+{
+    if (_transientMemory.empty() && _transientImages.empty())
+        return;
+
+    // Frames that are still in flight may be using the images.
+    auto images = std::make_shared<std::vector<Image>>(std::move(_transientImages));
+    std::vector<VmaAllocation> allocations;
+
+    for (const auto& memory : _transientMemory)
+        allocations.push_back(memory.Allocation);
+
+    _gpu->DeferDestroy([device = _gpu->_device, allocator = _gpu->_allocator, images, vkImages = _transientVkImages,
+                           allocations] {
+        images->clear();
+
+        for (VkImage vkImage : vkImages)
+        {
+            if (vkImage != VK_NULL_HANDLE)
+                vkDestroyImage(device, vkImage, nullptr);
+        }
+
+        for (VmaAllocation allocation : allocations)
+        {
+            if (allocation)
+                vmaFreeMemory(allocator, allocation);
+        }
+    });
+
+    _transientImages.clear();
+    _transientVkImages.clear();
+    _transientMemory.clear();
+    _isCompiled = false;
+}
+
+void RenderGraph::CreateBarriers()
+{
+    // The first pass that uses some transient memory each frame has to wait for the last pass that used it in
+    // the previous frame, so work out where each frame leaves the memory before recording any barriers.
+    SimulateAccesses(false);
+    SimulateAccesses(true);
+}
+
+void RenderGraph::SimulateAccesses(bool shouldRecordBarriers)
+{
+    std::vector<AccessState> imageStates(_imageResources.size());
+    std::vector<AccessState> bufferStates(_bufferResources.size());
+
+    // Nothing is known about how imported resources were used before the graph, so the
+    // first use of each waits for all earlier work.
+    for (size_t i = 0; i < _imageResources.size(); i++)
+    {
+        if (!_imageResources[i].Imported)
+            continue;
+
+        imageStates[i].Layout = _imageResources[i].Imported->_layout;
+        imageStates[i].WriteStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        imageStates[i].WriteAccess = VK_ACCESS_MEMORY_WRITE_BIT;
+    }
+
+    for (auto& state : bufferStates)
+    {
+        state.WriteStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        state.WriteAccess = VK_ACCESS_MEMORY_WRITE_BIT;
+    }
+
+    for (uint32_t passIndex : _executionOrder)
+    {
+        Pass& pass = _passes[passIndex];
+        BarrierBatch batch{};
+
+        // A pass may use a resource more than once, eg. reading and writing a storage image,
+        // so combine its uses of each resource into a single access.
+        std::vector<uint32_t> handledImages;
+
+        for (const auto& use : pass.ImageUses)
+        {
+            if (std::find(handledImages.begin(), handledImages.end(), use.Image) != handledImages.end())
+                continue;
+
+            handledImages.push_back(use.Image);
+
+            Access access = GetImageAccess(use.Image, use.Access, use.IsWrite);
+            bool isWrite = use.IsWrite;
+
+            for (const auto& other : pass.ImageUses)
+            {
+                if (other.Image != use.Image)
+                    continue;
+
+                Access otherAccess = GetImageAccess(other.Image, other.Access, other.IsWrite);
+
+                if (otherAccess.Layout != access.Layout)
+                    throw std::runtime_error("Tried to use an image in two layouts in pass \"" + pass.Name + "\"!");
+
+                access.Stages |= otherAccess.Stages;
+                access.AccessMask |= otherAccess.AccessMask;
+                isWrite = isWrite || other.IsWrite;
+            }
+
+            const ImageResource& resource = _imageResources[use.Image];
+            bool isFirstUse = !resource.Imported && resource.FirstUse == pass.Position;
+
+            if (isFirstUse)
+            {
+                // The image's contents are undefined, but the memory may have been used by another image.
+                const TransientMemory& memory = _transientMemory[resource.MemoryIndex];
+                imageStates[use.Image] = AccessState{};
+                imageStates[use.Image].WriteStages = memory.LastStages;
+                imageStates[use.Image].WriteAccess = memory.LastWriteAccess;
+            }
+
+            AddImageBarrier(batch, use.Image, imageStates[use.Image], access, isWrite, isFirstUse);
+
+            if (!resource.Imported)
+            {
+                TransientMemory& memory = _transientMemory[resource.MemoryIndex];
+                memory.LastStages = imageStates[use.Image].WriteStages | imageStates[use.Image].ReadStages;
+                memory.LastWriteAccess = imageStates[use.Image].WriteAccess;
+            }
+        }
+
+        std::vector<uint32_t> handledBuffers;
+
+        for (const auto& use : pass.BufferUses)
+        {
+            if (std::find(handledBuffers.begin(), handledBuffers.end(), use.Buffer) != handledBuffers.end())
+                continue;
+
+            handledBuffers.push_back(use.Buffer);
+
+            Access access = GetBufferAccess(use.Access, use.IsWrite);
+            bool isWrite = use.IsWrite;
+
+            for (const auto& other : pass.BufferUses)
+            {
+                if (other.Buffer != use.Buffer)
+                    continue;
+
+                Access otherAccess = GetBufferAccess(other.Access, other.IsWrite);
+                access.Stages |= otherAccess.Stages;
+                access.AccessMask |= otherAccess.AccessMask;
+                isWrite = isWrite || other.IsWrite;
+            }
+
+            AddBufferBarrier(batch, use.Buffer, bufferStates[use.Buffer], access, isWrite);
+        }
+
+        if (shouldRecordBarriers)
+            pass.Barriers = std::move(batch);
+    }
+
+    if (!shouldRecordBarriers)
+        return;
+
+    // Return imported resources to how they are expected to be outside of the graph, without
+    // knowing what will use them next.
+    _finalBarriers = BarrierBatch{};
+    Access externalAccess{VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED};
+
+    for (uint32_t i = 0; i < _imageResources.size(); i++)
+    {
+        const ImageResource& resource = _imageResources[i];
+        AccessState& state = imageStates[i];
+
+        if (!resource.Imported || !resource.IsUsed)
+            continue;
+
+        // Images that the graph only read in their usual layout still have the initial state.
+        bool isUnchanged = state.WriteAccess == 0 || state.WriteStages == VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        if (state.Layout == resource.Imported->_layout && isUnchanged)
+            continue;
+
+        externalAccess.Layout = resource.Imported->_layout;
+        AddImageBarrier(_finalBarriers, i, state, externalAccess, true, false);
+    }
+
+    for (uint32_t i = 0; i < _bufferResources.size(); i++)
+    {
+        AccessState& state = bufferStates[i];
+
+        // Buffers that weren't written by the graph still have the initial state, which needs no barrier.
+        if (state.WriteAccess == 0 || state.WriteStages == VK_PIPELINE_STAGE_ALL_COMMANDS_BIT)
+            continue;
+
+        AddBufferBarrier(_finalBarriers, i, state, externalAccess, true);
+    }
+}
+
+void RenderGraph::AddImageBarrier(BarrierBatch& batch, uint32_t image, AccessState& state, const Access& access,
+    bool isWrite, bool isFirstUse)
+{
+    bool isLayoutChanging = isFirstUse || state.Layout != access.Layout;
+    VkPipelineStageFlags srcStages = 0;
+    VkAccessFlags srcAccess = 0;
+    bool needsBarrier = false;
+
+    if (isWrite || isLayoutChanging)
+    {
+        // Wait for the last write and any reads since, the layout transition is a write too.
+        srcStages = state.WriteStages | state.ReadStages;
+        srcAccess = state.WriteAccess;
+        needsBarrier = isLayoutChanging || srcStages != 0;
+    }
+    else if (state.WriteStages != 0)
+    {
+        // Reads only need a barrier if they haven't already waited for the last write.
+        bool hasWaited = (access.Stages & ~state.ReadStages) == 0 && (access.AccessMask & ~state.ReadAccess) == 0;
+        srcStages = state.WriteStages;
+        srcAccess = state.WriteAccess;
+        needsBarrier = !hasWaited;
+    }
+
+    if (needsBarrier)
+    {
+        batch.SrcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        batch.DstStages |= access.Stages;
+        batch.ImageBarriers.push_back(ImageBarrier{image, isFirstUse ? VK_IMAGE_LAYOUT_UNDEFINED : state.Layout,
+            access.Layout, srcAccess, access.AccessMask});
+    }
+
+    if (isWrite || isLayoutChanging)
+    {
+        state.Layout = access.Layout;
+        state.WriteStages = access.Stages;
+        state.WriteAccess = isWrite ? access.AccessMask & WriteAccessFlags : 0;
+        state.ReadStages = isWrite ? 0 : access.Stages;
+        state.ReadAccess = isWrite ? 0 : access.AccessMask;
+    }
+    else
+    {
+        state.ReadStages |= access.Stages;
+        state.ReadAccess |= access.AccessMask;
+    }
+}
+
+void RenderGraph::AddBufferBarrier(
+    BarrierBatch& batch, uint32_t buffer, AccessState& state, const Access& access, bool isWrite)
+{
+    VkPipelineStageFlags srcStages = 0;
+    VkAccessFlags srcAccess = 0;
+    bool needsBarrier = false;
+
+    if (isWrite)
+    {
+        srcStages = state.WriteStages | state.ReadStages;
+        srcAccess = state.WriteAccess;
+        needsBarrier = srcStages != 0;
+    }
+    else if (state.WriteStages != 0)
+    {
+        bool hasWaited = (access.Stages & ~state.ReadStages) == 0 && (access.AccessMask & ~state.ReadAccess) == 0;
+        srcStages = state.WriteStages;
+        srcAccess = state.WriteAccess;
+        needsBarrier = !hasWaited;
+    }
+
+    if (needsBarrier)
+    {
+        batch.SrcStages |= srcStages;
+        batch.DstStages |= access.Stages;
+        batch.BufferBarriers.push_back(BufferBarrier{buffer, srcAccess, access.AccessMask});
+    }
+
+    if (isWrite)
+    {
+        state.WriteStages = access.Stages;
+        state.WriteAccess = access.AccessMask & WriteAccessFlags;
+        state.ReadStages = 0;
+        state.ReadAccess = 0;
+    }
+    else
+    {
+        state.ReadStages |= access.Stages;
+        state.ReadAccess |= access.AccessMask;
+    }
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch)
+{
+    if (batch.ImageBarriers.empty() && batch.BufferBarriers.empty())
+        return;
+
+    _vkImageBarriers.clear();
+    _vkBufferBarriers.clear();
+
+    for (const auto& barrier : batch.ImageBarriers)
+    {
+        const Image& image = GetImage(RenderGraphImage{barrier.Image});
+        _vkImageBarriers.push_back(
+            image.CreateBarrier(barrier.OldLayout, barrier.NewLayout, barrier.SrcAccess, barrier.DstAccess));
+    }
+
+    for (const auto& barrier : batch.BufferBarriers)
+    {
+        VkBufferMemoryBarrier bufferBarrier{};
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask = barrier.SrcAccess;
+        bufferBarrier.dstAccessMask = barrier.DstAccess;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer = _bufferResources[barrier.Buffer].Imported->_buffer;
+        bufferBarrier.offset = 0;
+        bufferBarrier.size = VK_WHOLE_SIZE;
+        _vkBufferBarriers.push_back(bufferBarrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, batch.SrcStages, batch.DstStages, 0, 0, nullptr,
+        static_cast<uint32_t>(_vkBufferBarriers.size()), _vkBufferBarriers.data(),
+        static_cast<uint32_t>(_vkImageBarriers.size()), _vkImageBarriers.data());
+}
+
+void RenderGraph::BeginRendering(VkCommandBuffer commandBuffer, const Pass& pass)
+{
+    std::vector<VkRenderingAttachmentInfoKHR> colorAttachments;
+    VkExtent2D extent{};
+
+    auto getLoadOp = [&](uint32_t image) {
+        const ImageResource& resource = _imageResources[image];
+
+        if (pass.HasClearColor)
+            return VK_ATTACHMENT_LOAD_OP_CLEAR;
+
+        return !resource.Imported && resource.FirstUse == pass.Position ? VK_ATTACHMENT_LOAD_OP_DONT_CARE
+                                                                        : VK_ATTACHMENT_LOAD_OP_LOAD;
+    };
+
+    // Transient attachments don't need to be stored after their last use, unless they are an output.
+    auto getStoreOp = [&](uint32_t image) {
+        const ImageResource& resource = _imageResources[image];
+        bool isDiscarded = !resource.Imported && !resource.IsOutput && resource.LastUse == pass.Position;
+
+        return isDiscarded ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+    };
+
+    auto setExtent = [&](const Image& image) {
+        if (extent.width != 0 && (extent.width != image._width || extent.height != image._height))
+            throw std::runtime_error("Tried to render to attachments of different sizes in \"" + pass.Name + "\"!");
+
+        extent = {image._width, image._height};
+    };
+
+    for (uint32_t image : GetColorAttachments(pass))
+    {
+        const Image& colorImage = GetImage(RenderGraphImage{image});
+        setExtent(colorImage);
+
+        VkRenderingAttachmentInfoKHR colorAttachment{};
+        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        colorAttachment.imageView = colorImage._view;
+        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.loadOp = getLoadOp(image);
+        colorAttachment.storeOp = getStoreOp(image);
+        colorAttachment.clearValue.color = {
+            {pass.ClearValue.R, pass.ClearValue.G, pass.ClearValue.B, pass.ClearValue.A}};
+        colorAttachments.push_back(colorAttachment);
+    }
+
+    VkRenderingAttachmentInfoKHR depthAttachment{};
+    const ImageUse* depthUse = GetDepthAttachment(pass);
+
+    if (depthUse)
+    {
+        const Image& depthImage = GetImage(RenderGraphImage{depthUse->Image});
+        setExtent(depthImage);
+
+        depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        depthAttachment.imageView = depthImage._view;
+        depthAttachment.clearValue.depthStencil = {1.0f, 0};
+
+        if (depthUse->IsWrite)
+        {
+            depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            depthAttachment.loadOp = getLoadOp(depthUse->Image);
+            depthAttachment.storeOp = getStoreOp(depthUse->Image);
+        }
+        else
+        {
+            // Read only depth has to keep its contents.
+            depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        }
+    }
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+    renderingInfo.pColorAttachments = colorAttachments.data();
+    renderingInfo.pDepthAttachment = depthUse ? &depthAttachment : nullptr;
+
+    _gpu->_vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = extent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+std::vector<uint32_t> RenderGraph::GetColorAttachments(const Pass& pass) const
+{
+    std::vector<uint32_t> colorAttachments;
+
+    for (const auto& use : pass.ImageUses)
+    {
+        if (use.Access == ImageAccess::ColorAttachment)
+            colorAttachments.push_back(use.Image);
+    }
+
+    return colorAttachments;
+}
+
+const RenderGraph::ImageUse* RenderGraph::GetDepthAttachment(const Pass& pass) const
+{
+    const ImageUse* depthAttachment = nullptr;
+
+    for (const auto& use : pass.ImageUses)
+    {
+        if (use.Access != ImageAccess::DepthAttachment)
+            continue;
+
+        if (depthAttachment && depthAttachment->Image != use.Image)
+            throw std::runtime_error("Tried to use more than one depth attachment in pass \"" + pass.Name + "\"!");
+
+        // A write takes priority over a read of the same attachment.
+        if (!depthAttachment || use.IsWrite)
+            depthAttachment = &use;
+    }
+
+    return depthAttachment;
+}
+
+std::vector<VkFormat> RenderGraph::GetColorFormats(RenderGraphPass pass) const
+{
+    std::vector<VkFormat> colorFormats;
+
+    for (uint32_t image : GetColorAttachments(GetPass(pass)))
+        colorFormats.push_back(_imageResources[image].Format);
+
+    return colorFormats;
+}
+
+VkFormat RenderGraph::GetDepthFormat(RenderGraphPass pass) const
+{
+    const ImageUse* depthAttachment = GetDepthAttachment(GetPass(pass));
+
+    return depthAttachment ? _imageResources[depthAttachment->Image].Format : VK_FORMAT_UNDEFINED;
+}
+
+VkImageLayout RenderGraph::GetShaderReadLayout(uint32_t image) const
+{
+    const ImageResource& resource = _imageResources[image];
+
+    if (resource.Imported)
+        return resource.Imported->_layout == VK_IMAGE_LAYOUT_GENERAL ? VK_IMAGE_LAYOUT_GENERAL
+                                                                     : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // Images that are also used for storage stay in the general layout, so that their descriptors stay valid.
+    return resource.UsesStorage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+VkExtent2D RenderGraph::GetTransientExtent(const ImageResource& resource) const
+{
+    if (resource.Options.Width != 0)
+        return VkExtent2D{resource.Options.Width, resource.Options.Height};
+
+    const VkExtent2D& swapchainExtent = _gpu->Swapchain._extent;
+    uint32_t width = static_cast<uint32_t>(swapchainExtent.width * resource.Options.Scale);
+    uint32_t height = static_cast<uint32_t>(swapchainExtent.height * resource.Options.Scale);
+
+    return VkExtent2D{std::max(width, 1u), std::max(height, 1u)};
+}
+
+RenderGraph::Access RenderGraph::GetImageAccess(uint32_t image, ImageAccess access, bool isWrite) const
+{
+    switch (access)
+    {
+        case ImageAccess::ColorAttachment:
+            return Access{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case ImageAccess::DepthAttachment:
+            if (isWrite)
+            {
+                return Access{VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+            }
+
+            return Access{VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        case ImageAccess::Sampled:
+            return Access{ShaderStages, VK_ACCESS_SHADER_READ_BIT, GetShaderReadLayout(image)};
+        case ImageAccess::Storage:
+            return Access{ShaderStages, isWrite ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_GENERAL};
+        case ImageAccess::Transfer:
+            if (isWrite)
+            {
+                return Access{VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+            }
+
+            return Access{
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        default:
+            throw std::runtime_error("Tried to get an access from an invalid image access!");
+    }
+}
+
+RenderGraph::Access RenderGraph::GetBufferAccess(BufferAccess access, bool isWrite)
+{
+    switch (access)
+    {
+        case BufferAccess::Vertex:
+            return Access{VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT};
+        case BufferAccess::Index:
+            return Access{VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT};
+        case BufferAccess::Indirect:
+            return Access{VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT};
+        case BufferAccess::Uniform:
+            return Access{ShaderStages, VK_ACCESS_UNIFORM_READ_BIT};
+        case BufferAccess::Storage:
+            return Access{ShaderStages, isWrite ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT};
+        case BufferAccess::Transfer:
+            return Access{
+                VK_PIPELINE_STAGE_TRANSFER_BIT, isWrite ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT};
+        default:
+            throw std::runtime_error("Tried to get an access from an invalid buffer access!");
+    }
+}
+
+VkImageUsageFlags RenderGraph::GetImageUsage(ImageAccess access, bool isWrite)
+{
+    switch (access)
+    {
+        case ImageAccess::ColorAttachment:
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        case ImageAccess::DepthAttachment:
+            return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        case ImageAccess::Sampled:
+            return VK_IMAGE_USAGE_SAMPLED_BIT;
+        case ImageAccess::Storage:
+            return VK_IMAGE_USAGE_STORAGE_BIT;
+        case ImageAccess::Transfer:
+            return isWrite ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        default:
+            throw std::runtime_error("Tried to get VkImageUsageFlags from an invalid image access!");
+    }
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "Gpu.hpp"
+#include "Image.hpp"
+#include "RenderGraphOptions.hpp"
+#include "RenderPassOptions.hpp"
+
+namespace GpuVk
+{
+// A frame made of passes that declare the images and buffers they read and write. Compiling the graph culls passes
+// that don't contribute to an output, works out the barriers and layout transitions needed between the remaining
+// passes, and creates transient images, aliasing the memory of any that are never in use at the same time.
+// Passes that write color or depth attachments are rendered to them using dynamic rendering.
+class RenderGraph
+{
+    friend class Pipeline;
+
+    public:
+    RenderGraph() = default;
+    RenderGraph(std::shared_ptr<Gpu> gpu);
+    RenderGraph(RenderGraph&& other);
+    RenderGraph& operator=(RenderGraph&& other);
+    ~RenderGraph();
+
+    // Imported resources are owned outside of the graph and need to outlive it. Imported images are
+    // expected to be in their usual layout outside of the graph, and are returned to it after each frame.
+    RenderGraphImage ImportImage(const Image& image);
+    RenderGraphBuffer ImportBuffer(const Buffer& buffer);
+    // Transient images are created by the graph when it's compiled, their contents only last for a frame.
+    RenderGraphImage CreateImage(const TransientImageOptions& options);
+
+    // Passes run in an order worked out from the resources they read and write, recording their commands into the
+    // current command buffer. A pass reads what the last pass added before it wrote, and passes that don't depend
+    // on each other keep the order they were added in. Transient images have no contents before they're written,
+    // so a pass can read one that a pass added after it writes, which then runs first. Cycles throw when compiling.
+    RenderGraphPass AddPass(const std::string& name, std::function<void()> record);
+    void Read(RenderGraphPass pass, RenderGraphImage image, ImageAccess access);
+    void Write(RenderGraphPass pass, RenderGraphImage image, ImageAccess access);
+    void Read(RenderGraphPass pass, RenderGraphBuffer buffer, BufferAccess access);
+    void Write(RenderGraphPass pass, RenderGraphBuffer buffer, BufferAccess access);
+    // Attachments are loaded unless the pass has a clear color, in which case depth is also cleared to 1.
+    void SetClearColor(RenderGraphPass pass, const ClearColor& clearColor);
+
+    // Passes are culled unless something they write is an output, or is read by a pass that isn't culled.
+    // Passes with effects that the graph can't see, eg. presenting with a RenderPass, should be kept explicitly.
+    void MarkOutput(RenderGraphImage image);
+    void MarkOutput(RenderGraphBuffer buffer);
+    void KeepPass(RenderGraphPass pass);
+
+    // Has to be called again after changing the graph, or resizing the swapchain if a transient image matches it.
+    void Compile();
+    void Execute();
+
+    const Image& GetImage(RenderGraphImage image) const;
+    bool IsPassCulled(RenderGraphPass pass) const;
+    VkDeviceSize GetTransientMemorySize() const;
+
+    private:
+    struct ImageResource
+    {
+        const Image* Imported = nullptr;
+        TransientImageOptions Options;
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        bool IsOutput = false;
+
+        // Filled in when compiling, from the passes that use the image.
+        VkImageUsageFlags Usage = 0;
+        bool IsUsed = false;
+        bool UsesStorage = false;
+        uint32_t FirstUse = 0;
+        uint32_t LastUse = 0;
+        uint32_t MemoryIndex = 0;
+    };
+
+    struct BufferResource
+    {
+        const Buffer* Imported = nullptr;
+        bool IsOutput = false;
+    };
+
+    struct ImageUse
+    {
+        uint32_t Image;
+        ImageAccess Access;
+        bool IsWrite;
+    };
+
+    struct BufferUse
+    {
+        uint32_t Buffer;
+        BufferAccess Access;
+        bool IsWrite;
+    };
+
+    struct ImageBarrier
+    {
+        uint32_t Image;
+        VkImageLayout OldLayout;
+        VkImageLayout NewLayout;
+        VkAccessFlags SrcAccess;
+        VkAccessFlags DstAccess;
+    };
+
+    struct BufferBarrier
+    {
+        uint32_t Buffer;
+        VkAccessFlags SrcAccess;
+        VkAccessFlags DstAccess;
+    };
+
+    // Barriers are stored by resource rather than by handle, since imported resources may be recreated.
+    struct BarrierBatch
+    {
+        VkPipelineStageFlags SrcStages = 0;
+        VkPipelineStageFlags DstStages = 0;
+        std::vector<ImageBarrier> ImageBarriers;
+        std::vector<BufferBarrier> BufferBarriers;
+    };
+
+    struct Pass
+    {
+        std::string Name;
+        std::function<void()> Record;
+        std::vector<ImageUse> ImageUses;
+        std::vector<BufferUse> BufferUses;
+        bool HasClearColor = false;
+        ClearColor ClearValue{};
+        bool IsKept = false;
+
+        // Filled in when compiling. Producers are the passes that wrote what this pass reads or overwrites,
+        // dependencies also include passes that have to read something before this pass overwrites it.
+        std::vector<uint32_t> Producers;
+        std::vector<uint32_t> Dependencies;
+        bool IsCulled = true;
+        uint32_t Position = 0;
+        BarrierBatch Barriers;
+    };
+
+    // How one pass uses a resource, a pass that both reads and writes it has a single access.
+    struct ResourceAccess
+    {
+        uint32_t Pass;
+        bool IsRead;
+        bool IsWrite;
+    };
+
+    struct Access
+    {
+        VkPipelineStageFlags Stages;
+        VkAccessFlags AccessMask;
+        VkImageLayout Layout;
+    };
+
+    // The most recent accesses to a resource, while working out barriers.
+    struct AccessState
+    {
+        VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags WriteStages = 0;
+        VkAccessFlags WriteAccess = 0;
+        // Stages and accesses that have waited for the last write.
+        VkPipelineStageFlags ReadStages = 0;
+        VkAccessFlags ReadAccess = 0;
+    };
+
+    struct TransientMemory
+    {
+        VmaAllocation Allocation = nullptr;
+        VkMemoryRequirements Requirements{};
+        std::vector<uint32_t> Images;
+        // The stages and writes of the last image to use the memory, which the next image has to wait for.
+        VkPipelineStageFlags LastStages = 0;
+        VkAccessFlags LastWriteAccess = 0;
+    };
+
+    Pass& GetPass(RenderGraphPass pass);
+    const Pass& GetPass(RenderGraphPass pass) const;
+    void AddImageUse(RenderGraphPass pass, RenderGraphImage image, ImageAccess access, bool isWrite);
+    void AddBufferUse(RenderGraphPass pass, RenderGraphBuffer buffer, BufferAccess access, bool isWrite);
+
+    void FindDependencies();
+    void AddDependencies(const std::vector<ResourceAccess>& accesses, bool isTransient);
+    void CullPasses();
+    void SortPasses();
+    void FindImageLifetimes();
+    void CreateTransientImages();
+    void DestroyTransientImages();
+    void CreateBarriers();
+    void SimulateAccesses(bool shouldRecordBarriers);
+    void AddImageBarrier(BarrierBatch& batch, uint32_t image, AccessState& state, const Access& access,
+        bool isWrite, bool isFirstUse);
+    void AddBufferBarrier(
+        BarrierBatch& batch, uint32_t buffer, AccessState& state, const Access& access, bool isWrite);
+
+    void RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+    void BeginRendering(VkCommandBuffer commandBuffer, const Pass& pass);
+
+    std::vector<uint32_t> GetColorAttachments(const Pass& pass) const;
+    const ImageUse* GetDepthAttachment(const Pass& pass) const;
+    std::vector<VkFormat> GetColorFormats(RenderGraphPass pass) const;
+    VkFormat GetDepthFormat(RenderGraphPass pass) const;
+    VkImageLayout GetShaderReadLayout(uint32_t image) const;
+    VkExtent2D GetTransientExtent(const ImageResource& resource) const;
+    Access GetImageAccess(uint32_t image, ImageAccess access, bool isWrite) const;
+
+    static Access GetBufferAccess(BufferAccess access, bool isWrite);
+    static VkImageUsageFlags GetImageUsage(ImageAccess access, bool isWrite);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    std::vector<ImageResource> _imageResources;
+    std::vector<BufferResource> _bufferResources;
+    std::vector<Pass> _passes;
+
+    bool _isCompiled = false;
+    std::vector<uint32_t> _executionOrder;
+    BarrierBatch _finalBarriers;
+
+    std::vector<Image> _transientImages;
+    std::vector<VkImage> _transientVkImages;
+    std::vector<TransientMemory> _transientMemory;
+
+    std::vector<VkImageMemoryBarrier> _vkImageBarriers;
+    std::vector<VkBufferMemoryBarrier> _vkBufferBarriers;
+};
+} // namespace GpuVk
\ No newline at end of file
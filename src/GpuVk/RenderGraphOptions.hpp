@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cinttypes>
+
+#include "ImageFormat.hpp"
+
+namespace GpuVk
+{
+// How a render graph pass uses an image, whether it is read or written is declared separately.
+enum class ImageAccess
+{
+    ColorAttachment,
+    // Reading a depth attachment only tests against it, without writing.
+    DepthAttachment,
+    Sampled,
+    Storage,
+    Transfer
+};
+
+// How a render graph pass uses a buffer, whether it is read or written is declared separately.
+enum class BufferAccess
+{
+    Vertex,
+    Index,
+    Indirect,
+    Uniform,
+    Storage,
+    Transfer
+};
+
+struct TransientImageOptions
+{
+    // When zero the image matches the size of the swapchain, multiplied by the scale.
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    float Scale = 1.0f;
+    ImageFormat Format = ImageFormat::Rgba8Unorm;
+    // Depth images use the GPU's preferred depth format instead of Format.
+    bool IsDepth = false;
+};
+
+struct RenderGraphImage
+{
+    uint32_t Id;
+};
+
+struct RenderGraphBuffer
+{
+    uint32_t Id;
+};
+
+struct RenderGraphPass
+{
+    uint32_t Id;
+};
+} // namespace GpuVk
\ No newline at end of file
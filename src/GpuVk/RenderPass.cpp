@@ -21,14 +21,26 @@ RenderPass& RenderPass::operator=(RenderPass&& other)
     std::swap(_options, other._options);
 
     std::swap(_renderPass, other._renderPass);
+    std::swap(_useDynamicRendering, other._useDynamicRendering);
 
     std::swap(_images, other._images);
     std::swap(_framebuffers, other._framebuffers);
 
+    std::swap(_subpasses, other._subpasses);
+    std::swap(_currentSubpass, other._currentSubpass);
+    std::swap(_additionalImages, other._additionalImages);
+
     std::swap(_depthImage, other._depthImage);
     std::swap(_colorImage, other._colorImage);
+    std::swap(_pooledVkImages, other._pooledVkImages);
+    std::swap(_attachmentMemory, other._attachmentMemory);
+    std::swap(_attachmentMemoryAlignment, other._attachmentMemoryAlignment);
+    std::swap(_retiredAttachmentMemory, other._retiredAttachmentMemory);
     std::swap(_imageFormat, other._imageFormat);
+    std::swap(_depthFormat, other._depthFormat);
     std::swap(_msaaSampleCount, other._msaaSampleCount);
+    std::swap(_extent, other._extent);
+    std::swap(_renderScale, other._renderScale);
 
     return *this;
 }
@@ -39,45 +51,124 @@ RenderPass::~RenderPass()
         return;
 
     CleanupResources();
-    vkDestroyRenderPass(_gpu->_device, _renderPass, nullptr);
+    FreeAttachmentMemory();
+
+    for (const RetiredMemory& retiredMemory : *_retiredAttachmentMemory)
+        vmaFreeMemory(_gpu->_allocator, retiredMemory.Allocation);
+
+    _gpu->DeferDestroy(
+        [device = _gpu->_device, renderPass = _renderPass] { vkDestroyRenderPass(device, renderPass, nullptr); });
 }
 
 void RenderPass::Create()
 {
-    _imageFormat = _gpu->Swapchain._imageFormat;
-    _msaaSampleCount = IsUsingMsaa() ? GetMaxUsableSampleCount(_gpu->_physicalDevice) : VK_SAMPLE_COUNT_1_BIT;
+    ValidateDepthOnly();
+    ValidateMultiview();
+
+    _imageFormat = FindColorFormat();
+    _depthFormat = FindDepthFormat();
+    _msaaSampleCount = IsUsingMsaa() ? GetUsableSampleCount(_options.MsaaSampleCount) : VK_SAMPLE_COUNT_1_BIT;
+
+    // Depth only passes have a single subpass that doesn't render to any color attachments.
+    SubpassOptions defaultSubpass{};
+
+    if (!_options.EnableColor)
+        defaultSubpass.ColorAttachments.clear();
+
+    _subpasses = _options.Subpasses.empty() ? std::vector<SubpassOptions>{defaultSubpass} : _options.Subpasses;
+
+    // Dynamic rendering has no subpasses, so it's only used for passes that don't need them.
+    bool hasSubpasses =
+        _subpasses.size() > 1 || !_subpasses[0].InputAttachments.empty() || _subpasses[0].EnableDepthInput;
+    _useDynamicRendering = _options.EnableDynamicRendering && _gpu->SupportsDynamicRendering() && !hasSubpasses;
+
+    ValidateSubpasses();
+
+    bool hasCustomExtent = _options.Width != 0 || _options.Height != 0 || _options.Scale != 1.0f;
+
+    if (hasCustomExtent && _options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to create a render pass that presents with a custom extent!");
+
+    if ((_options.Width == 0) != (_options.Height == 0))
+        throw std::runtime_error("Tried to create a render pass with only one of its width and height!");
+
+    if (_options.Scale <= 0.0f)
+        throw std::runtime_error("Tried to create a render pass with a scale that isn't positive!");
+
+    // Swapchain images and the transient MSAA attachments of presenting passes have no contents to load.
+    if (_options.EnableColor && _options.ColorAttachment.Load == LoadOp::Load &&
+        _options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to load a presented color attachment!");
+
+    if (!_useDynamicRendering)
+        CreateRenderPass();
+
+    UpdateExtent();
+    CreateImages();
+    CreateAttachments();
+    CreateFramebuffers();
+    TransitionLoadedImages();
+}
+
+void RenderPass::ValidateDepthOnly() const
+{
+    if (_options.EnableColor)
+        return;
+
+    if (!_options.EnableDepth)
+        throw std::runtime_error("Tried to create a render pass without color or depth!");
+
+    if (_options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to create a depth only render pass that presents!");
+
+    if (!_options.AdditionalColorAttachments.empty())
+        throw std::runtime_error("Tried to create a depth only render pass with additional color attachments!");
+}
+
+void RenderPass::ValidateMultiview() const
+{
+    if (_options.ViewMask == 0)
+        return;
+
+    if (!_gpu->_supportsMultiview)
+        throw std::runtime_error("Multiview isn't supported by the GPU!");
+
+    if (_options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to create a multiview render pass that presents!");
+
+    uint32_t viewCount = 0;
+
+    for (uint32_t viewMask = _options.ViewMask; viewMask != 0; viewMask >>= 1)
+        viewCount += viewMask & 1;
+
+    if (viewCount > _gpu->_maxMultiviewViewCount || GetLayerCount() > _gpu->_maxMultiviewViewCount)
+        throw std::runtime_error("Tried to create a render pass with more views than the GPU supports!");
+}
+
+void RenderPass::CreateRenderPass()
+{
+    bool isLoadingColor = _options.ColorAttachment.Load == LoadOp::Load;
+    bool isLoadingDepth = _options.DepthAttachment.Load == LoadOp::Load;
 
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = _imageFormat;
     colorAttachment.samples = _msaaSampleCount;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.loadOp = GetVkAttachmentLoadOp(_options.ColorAttachment.Load);
+    colorAttachment.storeOp = GetVkAttachmentStoreOp(_options.ColorAttachment.Store);
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-    switch (_options.ColorAttachmentUsage)
-    {
-        case ColorAttachmentUsage::Present:
-            colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-            break;
-        case ColorAttachmentUsage::PresentWithMsaa:
-            colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-            break;
-        case ColorAttachmentUsage::ReadFromShader:
-            colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            break;
-    }
+    colorAttachment.initialLayout = isLoadingColor ? GetColorFinalLayout() : VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = GetColorFinalLayout();
 
     VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = FindDepthFormat();
+    depthAttachment.format = _depthFormat;
     depthAttachment.samples = _msaaSampleCount;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.loadOp = GetVkAttachmentLoadOp(_options.DepthAttachment.Load);
+    depthAttachment.storeOp = GetVkAttachmentStoreOp(_options.DepthAttachment.Store);
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.initialLayout = isLoadingDepth ? GetDepthFinalLayout() : VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = GetDepthFinalLayout();
 
     VkAttachmentDescription colorAttachmentResolve{};
     colorAttachmentResolve.format = _imageFormat;
@@ -89,64 +180,253 @@ void RenderPass::Create()
     colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
-    VkAttachmentReference colorAttachmentRef{};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    std::vector<VkAttachmentDescription> attachments = {depthAttachment};
 
-    VkAttachmentReference depthAttachmentRef{};
-    depthAttachmentRef.attachment = 1;
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    if (_options.EnableColor)
+        attachments.insert(attachments.begin(), colorAttachment);
+
+    if (IsUsingMsaa())
+        attachments.push_back(colorAttachmentResolve);
 
-    VkAttachmentReference colorAttachmentResolveRef{};
-    colorAttachmentResolveRef.attachment = 2;
-    colorAttachmentResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    for (const auto& additionalAttachment : _options.AdditionalColorAttachments)
+    {
+        bool isStored = additionalAttachment.Store == StoreOp::Store;
+        bool isLoaded = additionalAttachment.Load == LoadOp::Load;
 
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
+        VkAttachmentDescription attachment{};
+        attachment.format = Image::GetVkFormat(additionalAttachment.Format);
+        attachment.samples = _msaaSampleCount;
+        attachment.loadOp = GetVkAttachmentLoadOp(additionalAttachment.Load);
+        attachment.storeOp = GetVkAttachmentStoreOp(additionalAttachment.Store);
+        attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.initialLayout = isLoaded ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        attachment.finalLayout =
+            isStored ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachments.push_back(attachment);
+    }
 
-    std::vector<VkAttachmentDescription> attachments = {colorAttachment, depthAttachment};
+    // The references have to stay alive until the render pass is created.
+    size_t subpassCount = _subpasses.size();
+    std::vector<std::vector<VkAttachmentReference>> colorAttachmentRefs(subpassCount);
+    std::vector<std::vector<VkAttachmentReference>> resolveAttachmentRefs(subpassCount);
+    std::vector<std::vector<VkAttachmentReference>> inputAttachmentRefs(subpassCount);
+    std::vector<std::vector<uint32_t>> preserveAttachments(subpassCount);
+    std::vector<VkAttachmentReference> depthAttachmentRefs(subpassCount);
+    std::vector<VkSubpassDescription> subpasses(subpassCount);
 
-    if (IsUsingMsaa())
+    // The main color attachment is resolved at the end of the last subpass that renders to it.
+    size_t resolvingSubpass = 0;
+
+    for (size_t i = 0; i < subpassCount; i++)
     {
-        subpass.pResolveAttachments = &colorAttachmentResolveRef;
-        attachments.push_back(colorAttachmentResolve);
+        if (IsAttachmentUsed(i, 0, false))
+            resolvingSubpass = i;
     }
 
-    if (_options.EnableDepth)
+    for (size_t i = 0; i < subpassCount; i++)
     {
-        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+        const SubpassOptions& subpassOptions = _subpasses[i];
+
+        for (uint32_t attachment : subpassOptions.ColorAttachments)
+        {
+            uint32_t resolveAttachment = attachment == 0 && i == resolvingSubpass ? 2 : VK_ATTACHMENT_UNUSED;
+
+            colorAttachmentRefs[i].push_back(
+                {GetVkAttachmentIndex(attachment), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+            resolveAttachmentRefs[i].push_back({resolveAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+        }
+
+        for (uint32_t attachment : subpassOptions.InputAttachments)
+        {
+            inputAttachmentRefs[i].push_back(
+                {GetVkAttachmentIndex(attachment), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+        }
+
+        // Depth that is read as an input attachment can only be used read only for depth testing in the same subpass.
+        VkImageLayout depthLayout = subpassOptions.EnableDepthInput ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                                                    : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachmentRefs[i] = {GetVkDepthAttachmentIndex(), depthLayout};
+
+        if (subpassOptions.EnableDepthInput)
+            inputAttachmentRefs[i].push_back(depthAttachmentRefs[i]);
+
+        // Attachments that aren't used by a subpass have to be preserved by it to keep their contents
+        // for a later subpass.
+        for (uint32_t attachment = 0; attachment <= _options.AdditionalColorAttachments.size(); attachment++)
+        {
+            bool isUsedBefore = false;
+            bool isUsedAfter = false;
+
+            for (size_t j = 0; j < subpassCount; j++)
+            {
+                isUsedBefore = isUsedBefore || (j < i && IsAttachmentUsed(j, attachment, true));
+                isUsedAfter = isUsedAfter || (j > i && IsAttachmentUsed(j, attachment, true));
+            }
+
+            if (!IsAttachmentUsed(i, attachment, true) && isUsedBefore && isUsedAfter)
+                preserveAttachments[i].push_back(GetVkAttachmentIndex(attachment));
+        }
+
+        auto usesDepth = [this](size_t j) { return _subpasses[j].EnableDepth || _subpasses[j].EnableDepthInput; };
+        bool isDepthUsedBefore = false;
+        bool isDepthUsedAfter = false;
+
+        for (size_t j = 0; j < subpassCount; j++)
+        {
+            isDepthUsedBefore = isDepthUsedBefore || (j < i && usesDepth(j));
+            isDepthUsedAfter = isDepthUsedAfter || (j > i && usesDepth(j));
+        }
+
+        if (_options.EnableDepth && !usesDepth(i) && isDepthUsedBefore && isDepthUsedAfter)
+            preserveAttachments[i].push_back(GetVkDepthAttachmentIndex());
+
+        VkSubpassDescription& subpass = subpasses[i];
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentRefs[i].size());
+        subpass.pColorAttachments = colorAttachmentRefs[i].data();
+        subpass.inputAttachmentCount = static_cast<uint32_t>(inputAttachmentRefs[i].size());
+        subpass.pInputAttachments = inputAttachmentRefs[i].data();
+        subpass.preserveAttachmentCount = static_cast<uint32_t>(preserveAttachments[i].size());
+        subpass.pPreserveAttachments = preserveAttachments[i].data();
+
+        if (IsUsingMsaa())
+            subpass.pResolveAttachments = resolveAttachmentRefs[i].data();
+
+        if (_options.EnableDepth && subpassOptions.EnableDepth)
+            subpass.pDepthStencilAttachment = &depthAttachmentRefs[i];
     }
 
+    // Loaded attachments also need the writes from the last time they were rendered to be visible.
+    VkPipelineStageFlags attachmentStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    VkAccessFlags attachmentWriteAccess =
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    VkAccessFlags attachmentAccess = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                     attachmentWriteAccess;
+
     VkSubpassDependency dependency{};
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     dependency.dstSubpass = 0;
-    dependency.srcStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.srcStageMask = attachmentStages;
+    dependency.srcAccessMask = attachmentWriteAccess;
+    dependency.dstStageMask = attachmentStages;
+    dependency.dstAccessMask = attachmentAccess;
+
+    std::vector<VkSubpassDependency> dependencies = {dependency};
+
+    // Subpasses that share an attachment run in order, and only depend on the same pixel in earlier subpasses.
+    for (uint32_t dst = 1; dst < subpassCount; dst++)
+    {
+        for (uint32_t src = 0; src < dst; src++)
+        {
+            if (!IsSharingAttachments(src, dst))
+                continue;
+
+            VkSubpassDependency subpassDependency{};
+            subpassDependency.srcSubpass = src;
+            subpassDependency.dstSubpass = dst;
+            subpassDependency.srcStageMask = attachmentStages | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            subpassDependency.srcAccessMask = attachmentWriteAccess;
+            subpassDependency.dstStageMask = attachmentStages | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            subpassDependency.dstAccessMask = attachmentAccess | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+            subpassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+            // Each view only reads what the same view rendered in the earlier subpass.
+            if (_options.ViewMask != 0)
+                subpassDependency.dependencyFlags |= VK_DEPENDENCY_VIEW_LOCAL_BIT;
+
+            dependencies.push_back(subpassDependency);
+        }
+    }
+
+    if (_options.ColorAttachmentUsage == ColorAttachmentUsage::ReadFromShader)
+    {
+        // Make the attachments' contents visible to the shaders that read them afterwards.
+        for (uint32_t src = 0; src < subpassCount; src++)
+        {
+            VkSubpassDependency readDependency{};
+            readDependency.srcSubpass = src;
+            readDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+            readDependency.srcStageMask = attachmentStages;
+            readDependency.srcAccessMask = attachmentWriteAccess;
+            readDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            readDependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            dependencies.push_back(readDependency);
+        }
+    }
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
     renderPassInfo.pAttachments = attachments.data();
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+    renderPassInfo.pSubpasses = subpasses.data();
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
+
+    // Every subpass renders all of the views.
+    std::vector<uint32_t> viewMasks(subpassCount, _options.ViewMask);
+
+    VkRenderPassMultiviewCreateInfo multiviewInfo{};
+    multiviewInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+    multiviewInfo.subpassCount = static_cast<uint32_t>(viewMasks.size());
+    multiviewInfo.pViewMasks = viewMasks.data();
+
+    if (_options.ViewMask != 0)
+        renderPassInfo.pNext = &multiviewInfo;
 
     if (vkCreateRenderPass(_gpu->_device, &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create render pass!");
     }
+}
 
-    CreateImages();
-    CreateDepthResources();
-    CreateColorResources();
-    CreateFramebuffers();
+void RenderPass::ValidateSubpasses() const
+{
+    size_t attachmentCount = _options.EnableColor ? _options.AdditionalColorAttachments.size() + 1 : 0;
+    bool isMainAttachmentWritten = !_options.EnableColor;
+
+    for (const auto& subpass : _subpasses)
+    {
+        for (uint32_t attachment : subpass.ColorAttachments)
+        {
+            if (attachment >= attachmentCount)
+                throw std::runtime_error("Tried to create a subpass that renders to an attachment that doesn't exist!");
+
+            isMainAttachmentWritten = isMainAttachmentWritten || attachment == 0;
+        }
+
+        for (uint32_t attachment : subpass.InputAttachments)
+        {
+            if (attachment >= attachmentCount)
+                throw std::runtime_error("Tried to create a subpass that reads an attachment that doesn't exist!");
+
+            auto& colorAttachments = subpass.ColorAttachments;
+            if (std::find(colorAttachments.begin(), colorAttachments.end(), attachment) != colorAttachments.end())
+                throw std::runtime_error("Tried to create a subpass that reads an attachment it also renders to!");
+        }
+
+        if (subpass.EnableDepthInput && !_options.EnableDepth)
+            throw std::runtime_error("Tried to create a subpass that reads depth in a render pass without depth!");
+    }
+
+    if (!isMainAttachmentWritten)
+        throw std::runtime_error("Tried to create a render pass that never renders to its main color attachment!");
+
+    // Every swapchain image would need its own descriptor to be read, so presented images can't be inputs.
+    if (IsAttachmentInput(0) && _options.ColorAttachmentUsage == ColorAttachmentUsage::Present)
+        throw std::runtime_error("Tried to read a swapchain image as an input attachment!");
+
+    for (const auto& attachment : _options.AdditionalColorAttachments)
+    {
+        if (attachment.Load == LoadOp::Load && attachment.Store != StoreOp::Store)
+            throw std::runtime_error("Tried to load an additional color attachment that isn't stored!");
+
+        if (attachment.Store == StoreOp::Store && _options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+            throw std::runtime_error("Tried to store an additional color attachment in a render pass that presents!");
+    }
 }
 
 void RenderPass::CreateImages()
@@ -167,27 +447,19 @@ void RenderPass::CreateImages()
 
 void RenderPass::Begin(const ClearColor& clearColor)
 {
-    auto extent = _gpu->Swapchain._extent;
-    auto currentImageIndex = _gpu->Swapchain._currentImageIndex;
+    auto extent = GetRenderExtent();
 
-    std::array<VkClearValue, 2> clearValues;
-    clearValues[0].color = {{clearColor.R, clearColor.G, clearColor.B, 1.0f}};
-    clearValues[1].depthStencil = {1.0f, 0};
+    _currentSubpass = 0;
 
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = _renderPass;
-    renderPassInfo.framebuffer = _framebuffers[currentImageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = extent;
+    if (_useDynamicRendering)
+        BeginRendering(clearColor);
+    else
+        BeginRenderPass(clearColor);
 
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
+    _gpu->Commands._isInRenderPass = true;
 
     auto commandBuffer = _gpu->Commands.GetBuffer();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -203,24 +475,393 @@ void RenderPass::Begin(const ClearColor& clearColor)
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
 
+void RenderPass::BeginRenderPass(const ClearColor& clearColor)
+{
+    auto extent = GetRenderExtent();
+    auto currentImageIndex = _gpu->Swapchain._currentImageIndex;
+
+    // Every attachment has a clear value, even though only those that are cleared use it.
+    std::vector<VkClearValue> clearValues(GetVkAttachmentIndex(1) + _options.AdditionalColorAttachments.size());
+
+    for (auto& clearValue : clearValues)
+        clearValue.color = {{clearColor.R, clearColor.G, clearColor.B, clearColor.A}};
+
+    clearValues[GetVkDepthAttachmentIndex()].depthStencil = {_options.ClearDepth, 0};
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = _renderPass;
+    renderPassInfo.framebuffer = _framebuffers[currentImageIndex];
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = extent;
+
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+
+    auto commandBuffer = _gpu->Commands.GetBuffer();
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void RenderPass::BeginRendering(const ClearColor& clearColor)
+{
+    auto extent = GetRenderExtent();
+    auto currentImageIndex = _gpu->Swapchain._currentImageIndex;
+    auto commandBuffer = _gpu->Commands.GetBuffer();
+
+    // Without a render pass object the attachments' layout transitions need to be recorded here instead.
+    const Image& colorTarget =
+        _options.ColorAttachmentUsage == ColorAttachmentUsage::Present ? _images[currentImageIndex] : _colorImage;
+
+    bool isLoadingColor = _options.ColorAttachment.Load == LoadOp::Load;
+    bool isLoadingDepth = _options.DepthAttachment.Load == LoadOp::Load;
+
+    if (_options.EnableColor)
+    {
+        colorTarget.RecordBarrier(commandBuffer, isLoadingColor ? GetColorFinalLayout() : VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            isLoadingColor ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    }
+
+    // Color attachments are in the same order as the subpass lists them, which pipelines' blend states match.
+    std::vector<VkRenderingAttachmentInfoKHR> colorAttachments;
+
+    for (uint32_t attachment : _subpasses[0].ColorAttachments)
+    {
+        VkRenderingAttachmentInfoKHR colorAttachment{};
+        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.clearValue.color = {{clearColor.R, clearColor.G, clearColor.B, clearColor.A}};
+
+        if (attachment == 0)
+        {
+            colorAttachment.imageView = colorTarget._view;
+            colorAttachment.loadOp = GetVkAttachmentLoadOp(_options.ColorAttachment.Load);
+            colorAttachment.storeOp = GetVkAttachmentStoreOp(_options.ColorAttachment.Store);
+        }
+        else
+        {
+            const ColorAttachmentOptions& options = _options.AdditionalColorAttachments[attachment - 1];
+            const Image& additionalImage = _additionalImages[attachment - 1];
+            bool isLoaded = options.Load == LoadOp::Load;
+
+            additionalImage.RecordBarrier(commandBuffer,
+                isLoaded ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                isLoaded ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+            colorAttachment.imageView = additionalImage._view;
+            colorAttachment.loadOp = GetVkAttachmentLoadOp(options.Load);
+            colorAttachment.storeOp = GetVkAttachmentStoreOp(options.Store);
+        }
+
+        if (attachment == 0 && IsUsingMsaa())
+        {
+            const Image& resolveTarget = _images[currentImageIndex];
+
+            resolveTarget.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+            colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+            colorAttachment.resolveImageView = resolveTarget._view;
+            colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
+
+        colorAttachments.push_back(colorAttachment);
+    }
+
+    VkRenderingAttachmentInfoKHR depthAttachment{};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depthAttachment.imageView = _depthImage._view;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = GetVkAttachmentLoadOp(_options.DepthAttachment.Load);
+    depthAttachment.storeOp = GetVkAttachmentStoreOp(_options.DepthAttachment.Store);
+    depthAttachment.clearValue.depthStencil = {_options.ClearDepth, 0};
+
+    if (_options.EnableDepth)
+    {
+        VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                           VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+        _depthImage.RecordBarrier(commandBuffer, isLoadingDepth ? GetDepthFinalLayout() : VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthStages,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, depthStages,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+    }
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.viewMask = _options.ViewMask;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+    renderingInfo.pColorAttachments = colorAttachments.data();
+    renderingInfo.pDepthAttachment = _options.EnableDepth ? &depthAttachment : nullptr;
+
+    _gpu->_vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+}
+
+void RenderPass::NextSubpass()
+{
+    if (_currentSubpass + 1 >= _subpasses.size())
+        throw std::runtime_error("Tried to move past the last subpass of a render pass!");
+
+    vkCmdNextSubpass(_gpu->Commands.GetBuffer(), VK_SUBPASS_CONTENTS_INLINE);
+    _currentSubpass++;
+}
+
 void RenderPass::End()
 {
+    if (_currentSubpass + 1 != _subpasses.size())
+        throw std::runtime_error("Tried to end a render pass before moving through all of its subpasses!");
+
+    _gpu->Commands._isInRenderPass = false;
+
+    if (_useDynamicRendering)
+    {
+        EndRendering();
+        return;
+    }
+
     vkCmdEndRenderPass(_gpu->Commands.GetBuffer());
 }
 
+void RenderPass::EndRendering()
+{
+    auto currentImageIndex = _gpu->Swapchain._currentImageIndex;
+    auto commandBuffer = _gpu->Commands.GetBuffer();
+
+    _gpu->_vkCmdEndRenderingKHR(commandBuffer);
+
+    switch (_options.ColorAttachmentUsage)
+    {
+        case ColorAttachmentUsage::Present:
+        case ColorAttachmentUsage::PresentWithMsaa:
+            _images[currentImageIndex].RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+            break;
+        case ColorAttachmentUsage::ReadFromShader:
+            if (!_options.EnableColor)
+                break;
+
+            _colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT);
+            break;
+    }
+
+    for (uint32_t attachment : _subpasses[0].ColorAttachments)
+    {
+        if (attachment == 0 || !IsAdditionalAttachmentStored(attachment))
+            continue;
+
+        _additionalImages[attachment - 1].RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    }
+
+    if (_options.EnableDepth && IsDepthSampled())
+    {
+        _depthImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            GetDepthFinalLayout(), VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_SHADER_READ_BIT);
+    }
+}
+
 const bool RenderPass::IsUsingMsaa() const
 {
     return _options.ColorAttachmentUsage == ColorAttachmentUsage::PresentWithMsaa;
 }
 
+const bool RenderPass::IsUsingDynamicRendering() const
+{
+    return _useDynamicRendering;
+}
+
 const Image& RenderPass::GetColorImage() const
 {
+    if (!_options.EnableColor)
+        throw std::runtime_error("Tried to get the color image of a depth only render pass!");
+
     return _colorImage;
 }
 
+const Image& RenderPass::GetDepthImage() const
+{
+    if (!IsDepthSampled() && !IsDepthInput())
+        throw std::runtime_error("Tried to get the depth image of a render pass that doesn't share it with shaders!");
+
+    return _depthImage;
+}
+
+const Image& RenderPass::GetAttachmentImage(uint32_t attachment) const
+{
+    if (attachment > _additionalImages.size() || !_options.EnableColor)
+        throw std::runtime_error("Tried to get the image of an attachment that doesn't exist!");
+
+    if (attachment == 0 && _options.ColorAttachmentUsage == ColorAttachmentUsage::Present)
+        throw std::runtime_error("Tried to get the image of a swapchain attachment!");
+
+    return attachment == 0 ? _colorImage : _additionalImages[attachment - 1];
+}
+
+VkExtent2D RenderPass::GetExtent() const
+{
+    return _extent;
+}
+
+VkExtent2D RenderPass::GetRenderExtent() const
+{
+    if (_renderScale == 1.0f)
+        return _extent;
+
+    uint32_t width = static_cast<uint32_t>(_extent.width * _renderScale);
+    uint32_t height = static_cast<uint32_t>(_extent.height * _renderScale);
+
+    // Leaves room for the edge to be repeated into, so upscaling can filter past it.
+    width = std::min(width, std::max(_extent.width, 2u) - 1);
+    height = std::min(height, std::max(_extent.height, 2u) - 1);
+
+    return VkExtent2D{std::max(width, 1u), std::max(height, 1u)};
+}
+
+void RenderPass::SetRenderScale(float renderScale)
+{
+    if (_options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to set the render scale of a render pass that presents!");
+
+    if (renderScale <= 0.0f || renderScale > 1.0f)
+        throw std::runtime_error("Tried to set a render scale outside of the range (0, 1]!");
+
+    _renderScale = renderScale;
+}
+
+float RenderPass::GetRenderScale() const
+{
+    return _renderScale;
+}
+
+void RenderPass::Upscale(const RenderPass& destination) const
+{
+    if (&destination == this)
+        throw std::runtime_error("Tried to upscale a render pass into itself!");
+
+    if (!_options.EnableColor || !destination._options.EnableColor ||
+        _options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader ||
+        destination._options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to upscale between render passes without sampled color images!");
+
+    if (_colorImage._layerCount != destination._colorImage._layerCount)
+        throw std::runtime_error("Tried to upscale between render passes with different layer counts!");
+
+    if (!_gpu->Commands._isRecording || _gpu->Commands._isInRenderPass)
+        throw std::runtime_error("Tried to upscale outside of a frame or inside of a render pass!");
+
+    VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    VkFormatProperties formatProperties;
+    VkFormatProperties destinationFormatProperties;
+    vkGetPhysicalDeviceFormatProperties(_gpu->_physicalDevice, _imageFormat, &formatProperties);
+    vkGetPhysicalDeviceFormatProperties(
+        _gpu->_physicalDevice, destination._imageFormat, &destinationFormatProperties);
+
+    if ((formatProperties.optimalTilingFeatures & blitFeatures) != blitFeatures ||
+        (destinationFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT) == 0)
+        throw std::runtime_error("Tried to upscale a render pass with a format that can't be blitted!");
+
+    auto commandBuffer = _gpu->Commands.GetBuffer();
+    VkExtent2D renderExtent = GetRenderExtent();
+    int32_t renderWidth = static_cast<int32_t>(renderExtent.width);
+    int32_t renderHeight = static_cast<int32_t>(renderExtent.height);
+
+    // The general layout lets the edge be copied within the image before it's blitted from.
+    _colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+    destination._colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    // Linear filtering reads one texel past the rendered part at its right and bottom edges, so the last rendered
+    // column and then the last row, including the new corner, are repeated into the texels left free for them.
+    VkImageCopy edgeCopy{};
+    edgeCopy.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, _colorImage._layerCount};
+    edgeCopy.dstSubresource = edgeCopy.srcSubresource;
+
+    if (renderExtent.width < _extent.width)
+    {
+        edgeCopy.srcOffset = {renderWidth - 1, 0, 0};
+        edgeCopy.dstOffset = {renderWidth, 0, 0};
+        edgeCopy.extent = {1, renderExtent.height, 1};
+
+        vkCmdCopyImage(commandBuffer, _colorImage._image, VK_IMAGE_LAYOUT_GENERAL, _colorImage._image,
+            VK_IMAGE_LAYOUT_GENERAL, 1, &edgeCopy);
+        _colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+    }
+
+    if (renderExtent.height < _extent.height)
+    {
+        edgeCopy.srcOffset = {0, renderHeight - 1, 0};
+        edgeCopy.dstOffset = {0, renderHeight, 0};
+        edgeCopy.extent = {std::min(renderExtent.width + 1, _extent.width), 1, 1};
+
+        vkCmdCopyImage(commandBuffer, _colorImage._image, VK_IMAGE_LAYOUT_GENERAL, _colorImage._image,
+            VK_IMAGE_LAYOUT_GENERAL, 1, &edgeCopy);
+        _colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_TRANSFER_READ_BIT);
+    }
+
+    VkImageBlit blit{};
+    blit.srcOffsets[0] = {0, 0, 0};
+    blit.srcOffsets[1] = {renderWidth, renderHeight, 1};
+    blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, _colorImage._layerCount};
+    blit.dstOffsets[0] = {0, 0, 0};
+    blit.dstOffsets[1] = {static_cast<int32_t>(destination._extent.width),
+        static_cast<int32_t>(destination._extent.height), 1};
+    blit.dstSubresource = blit.srcSubresource;
+
+    vkCmdBlitImage(commandBuffer, _colorImage._image, VK_IMAGE_LAYOUT_GENERAL, destination._colorImage._image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+    _colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT);
+    destination._colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
+glm::vec2 RenderPass::GetRenderUvScale() const
+{
+    VkExtent2D renderExtent = GetRenderExtent();
+
+    return glm::vec2(renderExtent.width, renderExtent.height) / glm::vec2(_extent.width, _extent.height);
+}
+
+glm::vec2 RenderPass::GetRenderUvMax() const
+{
+    VkExtent2D renderExtent = GetRenderExtent();
+
+    return (glm::vec2(renderExtent.width, renderExtent.height) - 0.5f) / glm::vec2(_extent.width, _extent.height);
+}
+
 void RenderPass::CreateFramebuffers()
 {
-    const VkExtent2D& extent = _gpu->Swapchain._extent;
+    if (_useDynamicRendering)
+        return;
 
     _framebuffers.resize(_images.size());
 
@@ -239,19 +880,23 @@ void RenderPass::CreateFramebuffers()
                 attachments.push_back(_images[i]._view);
                 break;
             case ColorAttachmentUsage::ReadFromShader:
-                attachments.push_back(_colorImage._view);
-                attachments.push_back(_depthImage._view);
+                if (_options.EnableColor)
+                    attachments.push_back(_colorImage._view);
 
+                attachments.push_back(_depthImage._view);
                 break;
         }
 
+        for (const auto& additionalImage : _additionalImages)
+            attachments.push_back(additionalImage._view);
+
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
         framebufferInfo.renderPass = _renderPass;
         framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
         framebufferInfo.pAttachments = attachments.data();
-        framebufferInfo.width = extent.width;
-        framebufferInfo.height = extent.height;
+        framebufferInfo.width = _extent.width;
+        framebufferInfo.height = _extent.height;
         framebufferInfo.layers = 1;
 
         if (vkCreateFramebuffer(_gpu->_device, &framebufferInfo, nullptr, &_framebuffers[i]) != VK_SUCCESS)
@@ -259,99 +904,523 @@ void RenderPass::CreateFramebuffers()
     }
 }
 
-void RenderPass::CreateDepthResources()
+void RenderPass::CreateAttachments()
 {
-    const VkExtent2D& extent = _gpu->Swapchain._extent;
+    std::vector<AttachmentImage> attachmentImages = GetAttachmentImages();
+    std::vector<VkImage> vkImages(attachmentImages.size(), VK_NULL_HANDLE);
+    std::vector<VkDeviceSize> offsets(attachmentImages.size(), 0);
+    VkMemoryRequirements poolRequirements{0, 1, ~0u};
+
+    for (size_t i = 0; i < attachmentImages.size(); i++)
+    {
+        const AttachmentImage& attachmentImage = attachmentImages[i];
 
-    VkFormat depthFormat = FindDepthFormat();
+        // Transient attachments keep their own lazily allocated memory where the GPU has it.
+        if (attachmentImage.Usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+            continue;
 
-    _depthImage = Image(_gpu, extent.width, extent.height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-        VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1, _msaaSampleCount);
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = _extent.width;
+        imageInfo.extent.height = _extent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = GetLayerCount();
+        imageInfo.format = attachmentImage.Format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = attachmentImage.Usage;
+        imageInfo.samples = _msaaSampleCount;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(_gpu->_device, &imageInfo, nullptr, &vkImages[i]) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create attachment image!");
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(_gpu->_device, vkImages[i], &requirements);
+
+        // Images that can't share a memory type with the others are allocated on their own instead.
+        if (!(poolRequirements.memoryTypeBits & requirements.memoryTypeBits))
+        {
+            vkDestroyImage(_gpu->_device, vkImages[i], nullptr);
+            vkImages[i] = VK_NULL_HANDLE;
+            continue;
+        }
+
+        offsets[i] = (poolRequirements.size + requirements.alignment - 1) / requirements.alignment *
+                     requirements.alignment;
+        poolRequirements.size = offsets[i] + requirements.size;
+        poolRequirements.alignment = std::max(poolRequirements.alignment, requirements.alignment);
+        poolRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+        _pooledVkImages.push_back(vkImages[i]);
+    }
+
+    if (!_pooledVkImages.empty())
+        AllocateAttachmentMemory(poolRequirements);
+
+    std::vector<Image> images;
+    images.reserve(attachmentImages.size());
+
+    for (size_t i = 0; i < attachmentImages.size(); i++)
+    {
+        const AttachmentImage& attachmentImage = attachmentImages[i];
+
+        if (vkImages[i] == VK_NULL_HANDLE)
+        {
+            images.push_back(Image(_gpu, _extent.width, _extent.height, attachmentImage.Format, attachmentImage.Usage,
+                attachmentImage.AspectFlags, 1, GetLayerCount(), _msaaSampleCount));
+            continue;
+        }
+
+        if (vmaBindImageMemory2(_gpu->_allocator, _attachmentMemory, offsets[i], vkImages[i], nullptr) != VK_SUCCESS)
+            throw std::runtime_error("Failed to bind attachment image memory!");
+
+        Image image(_gpu, vkImages[i], attachmentImage.Format, attachmentImage.AspectFlags, GetLayerCount());
+        image._width = _extent.width;
+        image._height = _extent.height;
+        image._usage = attachmentImage.Usage;
+        image._samples = _msaaSampleCount;
+        images.push_back(std::move(image));
+    }
+
+    // The images are in the same order as GetAttachmentImages lists them.
+    size_t nextImage = 0;
+
+    _depthImage = std::move(images[nextImage++]);
+    _depthImage._layout = GetDepthFinalLayout();
+
+    if (_options.EnableColor)
+        _colorImage = std::move(images[nextImage++]);
+
+    _additionalImages.clear();
+
+    while (nextImage < images.size())
+        _additionalImages.push_back(std::move(images[nextImage++]));
 }
 
-void RenderPass::CreateColorResources()
+void RenderPass::AllocateAttachmentMemory(const VkMemoryRequirements& requirements)
 {
-    const VkExtent2D& extent = _gpu->Swapchain._extent;
-
-    VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Frames in flight may still render into the old attachments, so their block is only reused once it's retired.
+    FreeAttachmentMemory();
 
-    switch (_options.ColorAttachmentUsage)
+    for (const RetiredMemory& retiredMemory : *_retiredAttachmentMemory)
     {
-        case ColorAttachmentUsage::Present:
-        case ColorAttachmentUsage::PresentWithMsaa:
-            imageUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
-            break;
-        case ColorAttachmentUsage::ReadFromShader:
-            imageUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
-            break;
+        VmaAllocationInfo allocationInfo;
+        vmaGetAllocationInfo(_gpu->_allocator, retiredMemory.Allocation, &allocationInfo);
+
+        bool isFitting = !_attachmentMemory && requirements.size <= allocationInfo.size &&
+                         requirements.alignment <= retiredMemory.Alignment &&
+                         (requirements.memoryTypeBits & (1u << allocationInfo.memoryType));
+
+        if (isFitting)
+        {
+            _attachmentMemory = retiredMemory.Allocation;
+            _attachmentMemoryAlignment = retiredMemory.Alignment;
+        }
+        else
+        {
+            vmaFreeMemory(_gpu->_allocator, retiredMemory.Allocation);
+        }
     }
 
-    _colorImage = Image(
-        _gpu, extent.width, extent.height, _imageFormat, imageUsage, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, _msaaSampleCount);
+    _retiredAttachmentMemory->clear();
+
+    if (_attachmentMemory)
+        return;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    if (vmaAllocateMemory(_gpu->_allocator, &requirements, &allocationInfo, &_attachmentMemory, nullptr) !=
+        VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate attachment memory!");
+
+    _attachmentMemoryAlignment = requirements.alignment;
 }
 
 void RenderPass::UpdateResources()
 {
     CleanupResources();
 
+    UpdateExtent();
     CreateImages();
-    CreateDepthResources();
-    CreateColorResources();
+    CreateAttachments();
     CreateFramebuffers();
+    TransitionLoadedImages();
 }
 
-VkFormat RenderPass::FindSupportedFormat(
-    const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
+void RenderPass::TransitionLoadedImages()
 {
-    for (VkFormat format : candidates)
+    bool isLoadingColor = _options.EnableColor && _options.ColorAttachment.Load == LoadOp::Load;
+    bool isLoadingDepth = _options.EnableDepth && _options.DepthAttachment.Load == LoadOp::Load;
+    bool isLoadingAdditional = false;
+
+    for (const auto& attachment : _options.AdditionalColorAttachments)
+        isLoadingAdditional = isLoadingAdditional || attachment.Load == LoadOp::Load;
+
+    if (!isLoadingColor && !isLoadingDepth && !isLoadingAdditional)
+        return;
+
+    // Loaded attachments are expected to already be in their final layout, even before the pass's first frame.
+    auto commandBuffer = _gpu->Commands.BeginSingleTime();
+
+    if (isLoadingColor)
     {
-        VkFormatProperties props;
-        vkGetPhysicalDeviceFormatProperties(_gpu->_physicalDevice, format, &props);
+        _colorImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, GetColorFinalLayout(),
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0);
+    }
+
+    if (isLoadingDepth)
+    {
+        _depthImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, GetDepthFinalLayout(),
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0);
+    }
+
+    for (size_t i = 0; i < _additionalImages.size(); i++)
+    {
+        if (_options.AdditionalColorAttachments[i].Load != LoadOp::Load)
+            continue;
+
+        _additionalImages[i].RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0);
+    }
+
+    _gpu->Commands.EndSingleTime(commandBuffer);
+}
+
+void RenderPass::CleanupResources()
+{
+    // Resizing doesn't wait for the device, so frames that are still in flight may be using the old resources.
+    auto images = std::make_shared<std::vector<Image>>(std::move(_images));
+    images->push_back(std::move(_depthImage));
+    images->push_back(std::move(_colorImage));
+
+    for (auto& additionalImage : _additionalImages)
+        images->push_back(std::move(additionalImage));
+
+    _gpu->DeferDestroy(
+        [device = _gpu->_device, images, framebuffers = _framebuffers, vkImages = _pooledVkImages] {
+            images->clear();
+
+            for (auto framebuffer : framebuffers)
+                vkDestroyFramebuffer(device, framebuffer, nullptr);
+
+            for (VkImage vkImage : vkImages)
+                vkDestroyImage(device, vkImage, nullptr);
+        });
+
+    _images.clear();
+    _framebuffers.clear();
+    _additionalImages.clear();
+    _pooledVkImages.clear();
+}
+
+void RenderPass::FreeAttachmentMemory()
+{
+    if (!_attachmentMemory)
+        return;
+
+    // The block is kept for reuse once it's retired, unless the render pass has been destroyed by then.
+    _gpu->DeferDestroy([allocator = _gpu->_allocator, retired = std::weak_ptr(_retiredAttachmentMemory),
+                           memory = RetiredMemory{_attachmentMemory, _attachmentMemoryAlignment}] {
+        if (auto retiredMemory = retired.lock())
+            retiredMemory->push_back(memory);
+        else
+            vmaFreeMemory(allocator, memory.Allocation);
+    });
+    _attachmentMemory = nullptr;
+}
 
-        if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
+bool RenderPass::IsDepthSampled() const
+{
+    return _options.ColorAttachmentUsage == ColorAttachmentUsage::ReadFromShader &&
+           _options.DepthAttachment.Store == StoreOp::Store;
+}
+
+bool RenderPass::IsAttachmentUsed(size_t subpass, uint32_t attachment, bool includeInputs) const
+{
+    const auto& colorAttachments = _subpasses[subpass].ColorAttachments;
+    const auto& inputAttachments = _subpasses[subpass].InputAttachments;
+
+    bool isColor = std::find(colorAttachments.begin(), colorAttachments.end(), attachment) != colorAttachments.end();
+    bool isInput = std::find(inputAttachments.begin(), inputAttachments.end(), attachment) != inputAttachments.end();
+
+    return isColor || (includeInputs && isInput);
+}
+
+bool RenderPass::IsAttachmentInput(uint32_t attachment) const
+{
+    for (const auto& subpass : _subpasses)
+    {
+        const auto& inputAttachments = subpass.InputAttachments;
+
+        if (std::find(inputAttachments.begin(), inputAttachments.end(), attachment) != inputAttachments.end())
+            return true;
+    }
+
+    return false;
+}
+
+bool RenderPass::IsDepthInput() const
+{
+    for (const auto& subpass : _subpasses)
+    {
+        if (subpass.EnableDepthInput)
+            return true;
+    }
+
+    return false;
+}
+
+bool RenderPass::IsAdditionalAttachmentStored(uint32_t attachment) const
+{
+    return _options.AdditionalColorAttachments[attachment - 1].Store == StoreOp::Store;
+}
+
+bool RenderPass::IsSharingAttachments(size_t src, size_t dst) const
+{
+    bool srcUsesDepth = _subpasses[src].EnableDepth || _subpasses[src].EnableDepthInput;
+    bool dstUsesDepth = _subpasses[dst].EnableDepth || _subpasses[dst].EnableDepthInput;
+
+    if (_options.EnableDepth && srcUsesDepth && dstUsesDepth)
+        return true;
+
+    for (uint32_t attachment = 0; attachment <= _options.AdditionalColorAttachments.size(); attachment++)
+    {
+        if (IsAttachmentUsed(src, attachment, true) && IsAttachmentUsed(dst, attachment, true))
+            return true;
+    }
+
+    return false;
+}
+
+uint32_t RenderPass::GetVkAttachmentIndex(uint32_t attachment) const
+{
+    // The render pass's attachments are the main color attachment, depth, the optional resolve
+    // attachment and then the additional color attachments.
+    if (attachment == 0)
+        return 0;
+
+    return attachment + (IsUsingMsaa() ? 2 : 1);
+}
+
+uint32_t RenderPass::GetVkDepthAttachmentIndex() const
+{
+    return _options.EnableColor ? 1 : 0;
+}
+
+uint32_t RenderPass::GetLayerCount() const
+{
+    // Views render to the layer with the same index, so there is a layer for every view up to the highest one.
+    uint32_t layerCount = 1;
+
+    for (uint32_t viewMask = _options.ViewMask >> 1; viewMask != 0; viewMask >>= 1)
+        layerCount++;
+
+    return layerCount;
+}
+
+VkFormat RenderPass::FindColorFormat() const
+{
+    if (!_options.ColorFormat)
+        return _gpu->Swapchain._imageFormat;
+
+    if (_options.ColorAttachmentUsage != ColorAttachmentUsage::ReadFromShader)
+        throw std::runtime_error("Tried to pick the color format of a render pass that presents!");
+
+    // Throws if the GPU can't both render to and sample the format.
+    return _gpu->FindSupportedFormat({Image::GetVkFormat(*_options.ColorFormat)}, VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+}
+
+VkFormat RenderPass::FindDepthFormat() const
+{
+    VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    if (IsDepthSampled())
+        features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+    switch (_options.DepthFormat)
+    {
+        case DepthFormat::Default:
+            return _gpu->FindSupportedFormat(
+                {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+                VK_IMAGE_TILING_OPTIMAL, features);
+        case DepthFormat::D16Unorm:
+            return _gpu->FindSupportedFormat({VK_FORMAT_D16_UNORM}, VK_IMAGE_TILING_OPTIMAL, features);
+        case DepthFormat::D32Float:
+            return _gpu->FindSupportedFormat({VK_FORMAT_D32_SFLOAT}, VK_IMAGE_TILING_OPTIMAL, features);
+        default:
+            throw std::runtime_error("Tried to find the format of an invalid depth format!");
+    }
+}
+
+std::vector<RenderPass::AttachmentImage> RenderPass::GetAttachmentImages() const
+{
+    std::vector<AttachmentImage> attachmentImages;
+
+    VkImageUsageFlags depthUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    // Attachments that are sampled after the render pass can be read back too.
+    if (IsDepthSampled())
+        depthUsage |= VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    if (IsDepthInput())
+        depthUsage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+    attachmentImages.push_back({_depthFormat, depthUsage, VK_IMAGE_ASPECT_DEPTH_BIT});
+
+    if (_options.EnableColor)
+    {
+        VkImageUsageFlags colorUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+        switch (_options.ColorAttachmentUsage)
+        {
+            case ColorAttachmentUsage::Present:
+            case ColorAttachmentUsage::PresentWithMsaa:
+                colorUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+                break;
+            case ColorAttachmentUsage::ReadFromShader:
+                // Transfers are also used to upscale from a lower render scale.
+                colorUsage |= VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                              VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+                break;
+        }
+
+        if (IsAttachmentInput(0))
+            colorUsage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+        attachmentImages.push_back({_imageFormat, colorUsage, VK_IMAGE_ASPECT_COLOR_BIT});
+    }
+
+    for (uint32_t attachment = 1; attachment <= _options.AdditionalColorAttachments.size(); attachment++)
+    {
+        VkImageUsageFlags additionalUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        VkFormatFeatureFlags formatFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+
+        if (IsAdditionalAttachmentStored(attachment))
         {
-            return format;
+            additionalUsage |= VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            formatFeatures |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
         }
-        else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
+        else
         {
-            return format;
+            additionalUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
         }
+
+        if (IsAttachmentInput(attachment))
+            additionalUsage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+        // Throws if the GPU can't render to the format, or sample it when that's needed.
+        VkFormat format = _gpu->FindSupportedFormat(
+            {Image::GetVkFormat(_options.AdditionalColorAttachments[attachment - 1].Format)},
+            VK_IMAGE_TILING_OPTIMAL, formatFeatures);
+
+        attachmentImages.push_back({format, additionalUsage, VK_IMAGE_ASPECT_COLOR_BIT});
     }
 
-    throw std::runtime_error("Failed to find supported format!");
+    return attachmentImages;
 }
 
-VkFormat RenderPass::FindDepthFormat()
+std::vector<VkFormat> RenderPass::GetColorFormats(uint32_t subpass) const
 {
-    return FindSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-        VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    if (subpass >= _subpasses.size())
+        throw std::runtime_error("Tried to get the color formats of a subpass that doesn't exist!");
+
+    std::vector<VkFormat> colorFormats;
+
+    for (uint32_t attachment : _subpasses[subpass].ColorAttachments)
+    {
+        if (attachment == 0)
+            colorFormats.push_back(_imageFormat);
+        else
+            colorFormats.push_back(Image::GetVkFormat(_options.AdditionalColorAttachments[attachment - 1].Format));
+    }
+
+    return colorFormats;
 }
 
-void RenderPass::CleanupResources()
+VkImageLayout RenderPass::GetColorFinalLayout() const
 {
-    for (auto framebuffer : _framebuffers)
-        vkDestroyFramebuffer(_gpu->_device, framebuffer, nullptr);
+    switch (_options.ColorAttachmentUsage)
+    {
+        case ColorAttachmentUsage::Present:
+            return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        case ColorAttachmentUsage::PresentWithMsaa:
+            return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        case ColorAttachmentUsage::ReadFromShader:
+            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        default:
+            throw std::runtime_error("Tried to get the final layout of an invalid color attachment usage!");
+    }
 }
 
-const VkSampleCountFlagBits RenderPass::GetMaxUsableSampleCount(VkPhysicalDevice physicalDevice)
+VkImageLayout RenderPass::GetDepthFinalLayout() const
+{
+    return IsDepthSampled() ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                            : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+}
+
+VkAttachmentLoadOp RenderPass::GetVkAttachmentLoadOp(LoadOp loadOp)
+{
+    switch (loadOp)
+    {
+        case LoadOp::Clear:
+            return VK_ATTACHMENT_LOAD_OP_CLEAR;
+        case LoadOp::Load:
+            return VK_ATTACHMENT_LOAD_OP_LOAD;
+        case LoadOp::DontCare:
+            return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        default:
+            throw std::runtime_error("Tried to get a VkAttachmentLoadOp from an invalid load op!");
+    }
+}
+
+VkAttachmentStoreOp RenderPass::GetVkAttachmentStoreOp(StoreOp storeOp)
+{
+    switch (storeOp)
+    {
+        case StoreOp::Store:
+            return VK_ATTACHMENT_STORE_OP_STORE;
+        case StoreOp::DontCare:
+            return VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        default:
+            throw std::runtime_error("Tried to get a VkAttachmentStoreOp from an invalid store op!");
+    }
+}
+
+void RenderPass::UpdateExtent()
+{
+    const VkExtent2D& swapchainExtent = _gpu->Swapchain._extent;
+
+    if (_options.Width != 0)
+    {
+        _extent = VkExtent2D{_options.Width, _options.Height};
+        return;
+    }
+
+    uint32_t width = static_cast<uint32_t>(swapchainExtent.width * _options.Scale);
+    uint32_t height = static_cast<uint32_t>(swapchainExtent.height * _options.Scale);
+
+    _extent = VkExtent2D{std::max(width, 1u), std::max(height, 1u)};
+}
+
+const VkSampleCountFlagBits RenderPass::GetUsableSampleCount(uint32_t requestedSampleCount)
 {
     VkPhysicalDeviceProperties physicalDeviceProperties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    vkGetPhysicalDeviceProperties(_gpu->_physicalDevice, &physicalDeviceProperties);
 
     VkSampleCountFlags counts = physicalDeviceProperties.limits.framebufferColorSampleCounts &
                                 physicalDeviceProperties.limits.framebufferDepthSampleCounts;
-    if (counts & VK_SAMPLE_COUNT_64_BIT)
-        return VK_SAMPLE_COUNT_64_BIT;
-    if (counts & VK_SAMPLE_COUNT_32_BIT)
-        return VK_SAMPLE_COUNT_32_BIT;
-    if (counts & VK_SAMPLE_COUNT_16_BIT)
-        return VK_SAMPLE_COUNT_16_BIT;
-    if (counts & VK_SAMPLE_COUNT_8_BIT)
-        return VK_SAMPLE_COUNT_8_BIT;
-    if (counts & VK_SAMPLE_COUNT_4_BIT)
-        return VK_SAMPLE_COUNT_4_BIT;
-    if (counts & VK_SAMPLE_COUNT_2_BIT)
-        return VK_SAMPLE_COUNT_2_BIT;
+
+    // Sample count flags have the same value as the count they represent.
+    for (uint32_t sampleCount = VK_SAMPLE_COUNT_64_BIT; sampleCount > VK_SAMPLE_COUNT_1_BIT; sampleCount >>= 1)
+    {
+        if (sampleCount <= requestedSampleCount && (counts & sampleCount))
+            return static_cast<VkSampleCountFlagBits>(sampleCount);
+    }
 
     return VK_SAMPLE_COUNT_1_BIT;
 }
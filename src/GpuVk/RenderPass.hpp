@@ -1,8 +1,10 @@
 #pragma once
 
+#include <glm/glm.hpp>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <vector>
@@ -25,39 +27,114 @@ class RenderPass
     ~RenderPass();
 
     void Begin(const ClearColor& clearColor);
+    // Moves to the next subpass, all of them have to be moved through before ending the render pass.
+    void NextSubpass();
     void End();
 
     const bool IsUsingMsaa() const;
+    const bool IsUsingDynamicRendering() const;
     const Image& GetColorImage() const;
+    const Image& GetDepthImage() const;
+    // The image of a color attachment, to be read as an input attachment by a later subpass, or sampled after the
+    // render pass if it's stored.
+    const Image& GetAttachmentImage(uint32_t attachment) const;
+    VkExtent2D GetExtent() const;
+    VkExtent2D GetRenderExtent() const;
+
+    // Renders to the top left part of the attachments, scaled by a factor between 0 and 1, without recreating them.
+    // Below a scale of 1 a column and a row are left past that part, for Upscale to repeat its edge into.
+    void SetRenderScale(float renderScale);
+    float GetRenderScale() const;
+    // Blits the rendered part of the color image over the whole color image of another pass that is read from a
+    // shader, with linear filtering. Has to be recorded into the current frame outside of a render pass.
+    void Upscale(const RenderPass& destination) const;
+    // Shaders that sample the rendered part themselves multiply their coordinates by the scale, then clamp them to
+    // the max, which is half a texel inside it so that filtering never reads texels that weren't rendered.
+    glm::vec2 GetRenderUvScale() const;
+    glm::vec2 GetRenderUvMax() const;
 
     void UpdateResources();
 
     private:
+    // An attachment that is described before it's created, so that the attachments can share one block of memory.
+    struct AttachmentImage
+    {
+        VkFormat Format;
+        VkImageUsageFlags Usage;
+        VkImageAspectFlags AspectFlags;
+    };
+
     void Create();
+    void ValidateDepthOnly() const;
+    void ValidateMultiview() const;
+    void CreateRenderPass();
+    void ValidateSubpasses() const;
     void CreateImages();
     void CreateFramebuffers();
-    void CreateDepthResources();
-    void CreateColorResources();
+    void CreateAttachments();
+    void AllocateAttachmentMemory(const VkMemoryRequirements& requirements);
+    void TransitionLoadedImages();
     void CleanupResources();
-
-    VkFormat FindSupportedFormat(
-        const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
-    VkFormat FindDepthFormat();
-
-    const VkSampleCountFlagBits GetMaxUsableSampleCount(VkPhysicalDevice physicalDevice);
+    void FreeAttachmentMemory();
+
+    void BeginRenderPass(const ClearColor& clearColor);
+    void BeginRendering(const ClearColor& clearColor);
+    void EndRendering();
+
+    const VkSampleCountFlagBits GetUsableSampleCount(uint32_t requestedSampleCount);
+    bool IsDepthSampled() const;
+    bool IsAttachmentUsed(size_t subpass, uint32_t attachment, bool includeInputs) const;
+    bool IsAttachmentInput(uint32_t attachment) const;
+    bool IsDepthInput() const;
+    bool IsAdditionalAttachmentStored(uint32_t attachment) const;
+    bool IsSharingAttachments(size_t src, size_t dst) const;
+    uint32_t GetVkAttachmentIndex(uint32_t attachment) const;
+    uint32_t GetVkDepthAttachmentIndex() const;
+    uint32_t GetLayerCount() const;
+    VkFormat FindColorFormat() const;
+    VkFormat FindDepthFormat() const;
+    std::vector<AttachmentImage> GetAttachmentImages() const;
+    std::vector<VkFormat> GetColorFormats(uint32_t subpass) const;
+    VkImageLayout GetColorFinalLayout() const;
+    VkImageLayout GetDepthFinalLayout() const;
+    static VkAttachmentLoadOp GetVkAttachmentLoadOp(LoadOp loadOp);
+    static VkAttachmentStoreOp GetVkAttachmentStoreOp(StoreOp storeOp);
+    void UpdateExtent();
 
     std::shared_ptr<Gpu> _gpu;
 
     RenderPassOptions _options;
 
-    VkRenderPass _renderPass;
+    VkRenderPass _renderPass = VK_NULL_HANDLE;
+    bool _useDynamicRendering = false;
 
     std::vector<Image> _images;
     std::vector<VkFramebuffer> _framebuffers;
 
+    std::vector<SubpassOptions> _subpasses;
+    uint32_t _currentSubpass = 0;
+    std::vector<Image> _additionalImages;
+
     Image _depthImage;
     Image _colorImage;
+    // Attachments that aren't transient are bound to one block. Blocks of earlier sizes are returned to the retired
+    // ones once frames in flight are done with them, and reused when resizing to a size that fits.
+    std::vector<VkImage> _pooledVkImages;
+    VmaAllocation _attachmentMemory = nullptr;
+    VkDeviceSize _attachmentMemoryAlignment = 0;
+
+    struct RetiredMemory
+    {
+        VmaAllocation Allocation;
+        VkDeviceSize Alignment;
+    };
+
+    std::shared_ptr<std::vector<RetiredMemory>> _retiredAttachmentMemory =
+        std::make_shared<std::vector<RetiredMemory>>();
     VkFormat _imageFormat;
+    VkFormat _depthFormat;
     VkSampleCountFlagBits _msaaSampleCount = VK_SAMPLE_COUNT_1_BIT;
+    VkExtent2D _extent{};
+    float _renderScale = 1.0f;
 };
 } // namespace GpuVk
\ No newline at end of file
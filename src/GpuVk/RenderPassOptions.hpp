@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cinttypes>
+#include <optional>
+#include <vector>
 
 #include "Format.hpp"
+#include "ImageFormat.hpp"
 
 namespace GpuVk
 {
@@ -11,6 +14,35 @@ struct ClearColor
     float R;
     float G;
     float B;
+    float A = 1.0f;
+};
+
+enum class LoadOp
+{
+    Clear,
+    Load,
+    DontCare
+};
+
+enum class StoreOp
+{
+    Store,
+    DontCare
+};
+
+enum class DepthFormat
+{
+    // The most precise format the GPU supports.
+    Default,
+    // Halves the memory and bandwidth of depth compared to 32 bit formats, eg. for shadow maps.
+    D16Unorm,
+    D32Float
+};
+
+struct AttachmentOptions
+{
+    LoadOp Load = LoadOp::Clear;
+    StoreOp Store = StoreOp::Store;
 };
 
 enum class ColorAttachmentUsage
@@ -20,9 +52,72 @@ enum class ColorAttachmentUsage
     ReadFromShader
 };
 
+// A color attachment in addition to the render pass's main one, eg. for each part of a G-buffer. Unless it's stored
+// it only lives within the render pass, to pass results from one subpass to the next as an input attachment while
+// they are still in on-chip memory.
+struct ColorAttachmentOptions
+{
+    ImageFormat Format = ImageFormat::Rgba8Unorm;
+    // Only stored attachments can be loaded, since the contents of the others aren't kept.
+    LoadOp Load = LoadOp::DontCare;
+    // Stored attachments can be sampled after the render pass, which has to be read from a shader.
+    StoreOp Store = StoreOp::DontCare;
+};
+
+// Attachments are referred to by index, 0 is the main color attachment and the additional
+// color attachments start from 1.
+struct SubpassOptions
+{
+    std::vector<uint32_t> ColorAttachments = {0};
+    std::vector<uint32_t> InputAttachments;
+    bool EnableDepth = true;
+    // Reads depth as an input attachment, it can still be tested against but not written.
+    bool EnableDepthInput = false;
+};
+
 struct RenderPassOptions
 {
     bool EnableDepth;
     ColorAttachmentUsage ColorAttachmentUsage;
+    // Depth only passes, eg. a depth pre-pass or a shadow map, have no color attachment and render with pipelines
+    // that have no fragment shader. They have to be read from a shader, and store depth for it to be sampled.
+    bool EnableColor = true;
+    // Passes that are read from a shader can render to another format than the swapchain's, eg. B10G11R11UFloat
+    // for HDR at half the bandwidth of Rgba16Float, which a final pass then tonemaps to the swapchain.
+    std::optional<ImageFormat> ColorFormat;
+    DepthFormat DepthFormat = DepthFormat::Default;
+    // Render directly to the attachments without render pass or framebuffer objects, if supported by the GPU.
+    bool EnableDynamicRendering = false;
+    // Loading continues from the contents that the pass left the last time it ended, which presented color
+    // attachments don't keep. Depth that is stored by a pass that is read from a shader can be sampled afterwards too.
+    AttachmentOptions ColorAttachment{};
+    AttachmentOptions DepthAttachment{LoadOp::Clear, StoreOp::DontCare};
+    float ClearDepth = 1.0f;
+    // Subpasses run in order, each one is moved to with RenderPass::NextSubpass. When empty there is a single
+    // subpass that renders to the main color attachment, if there is one. Passes with more than one subpass, or
+    // input attachments, use a render pass object even if dynamic rendering is enabled.
+    std::vector<ColorAttachmentOptions> AdditionalColorAttachments;
+    std::vector<SubpassOptions> Subpasses;
+    // Only used when presenting with MSAA, lowered to the highest count supported by the GPU if needed.
+    uint32_t MsaaSampleCount = 4;
+    // The size of the attachments when reading from a shader. An explicit width and height take priority,
+    // otherwise the swapchain's extent is multiplied by the scale. Presenting always uses the swapchain's extent.
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    float Scale = 1.0f;
+    // Each draw renders once per set bit into the attachment layer with the same index, eg. for shadow map
+    // cascades, cube faces or stereo eyes. Shaders pick each view's data, like its matrices, with gl_ViewIndex.
+    // Attachments become image arrays, and multiview can only be used when reading from a shader.
+    uint32_t ViewMask = 0;
+};
+
+struct DynamicResolutionOptions
+{
+    // The frame time to aim for, in seconds.
+    float TargetFrameTime = 1.0f / 60.0f;
+    float MinScale = 0.5f;
+    float MaxScale = 1.0f;
+    // How much each new frame time affects the average that the scale is based on, from 0 to 1.
+    float Smoothing = 0.1f;
 };
 } // namespace GpuVk
\ No newline at end of file
@@ -1,31 +1,37 @@
 #include "Sampler.hpp"
 #include "Gpu.hpp"
+#include "Pipeline.hpp"
+
+#include <algorithm>
 
 namespace GpuVk
 {
-Sampler::Sampler(std::shared_ptr<Gpu> gpu, const Image& image, FilterMode minFilter, FilterMode magFilter) : _gpu(gpu)
+Sampler::Sampler(std::shared_ptr<Gpu> gpu, const Image& image, FilterMode minFilter, FilterMode magFilter)
+    : Sampler(gpu, SamplerOptions{
+                       .MinFilter = minFilter,
+                       .MagFilter = magFilter,
+                       .MaxAnisotropy = minFilter == FilterMode::Linear ? gpu->_maxSamplerAnisotropy : 1.0f,
+                       .MaxLod = static_cast<float>(image.GetMipmapLevelCount()),
+                   })
 {
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(_gpu->_physicalDevice, &properties);
+}
 
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = GetVkFilter(magFilter);
-    samplerInfo.minFilter = GetVkFilter(minFilter);
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.maxLod = static_cast<float>(image.GetMipmapLevelCount());
+Sampler::Sampler(std::shared_ptr<Gpu> gpu, const SamplerOptions& options) : _gpu(gpu)
+{
+    SamplerOptions cacheOptions = options;
+    cacheOptions.MaxAnisotropy = std::clamp(options.MaxAnisotropy, 1.0f, _gpu->_maxSamplerAnisotropy);
 
-    if (vkCreateSampler(_gpu->_device, &samplerInfo, nullptr, &_sampler) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create texture sampler!");
+    for (const auto& cachedSampler : _gpu->_samplers)
+    {
+        if (cachedSampler.Options == cacheOptions)
+        {
+            _sampler = cachedSampler.Sampler;
+            return;
+        }
+    }
+
+    _sampler = CreateVkSampler(_gpu, cacheOptions);
+    _gpu->_samplers.push_back({cacheOptions, _sampler});
 }
 
 Sampler::Sampler(Sampler&& other)
@@ -42,12 +48,32 @@ Sampler& Sampler::operator=(Sampler&& other)
     return *this;
 }
 
-Sampler::~Sampler()
+VkSampler Sampler::CreateVkSampler(std::shared_ptr<Gpu> gpu, const SamplerOptions& options)
 {
-    if (!_gpu)
-        return;
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = GetVkFilter(options.MagFilter);
+    samplerInfo.minFilter = GetVkFilter(options.MinFilter);
+    samplerInfo.addressModeU = GetVkSamplerAddressMode(options.AddressModeU);
+    samplerInfo.addressModeV = GetVkSamplerAddressMode(options.AddressModeV);
+    samplerInfo.addressModeW = GetVkSamplerAddressMode(options.AddressModeW);
+    samplerInfo.anisotropyEnable = options.MaxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+    samplerInfo.maxAnisotropy = options.MaxAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = options.CompareOp ? VK_TRUE : VK_FALSE;
+    samplerInfo.compareOp = options.CompareOp ? Pipeline::GetVkCompareOp(*options.CompareOp) : VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = GetVkSamplerMipmapMode(options.MipmapMode);
+    samplerInfo.mipLodBias = options.MipLodBias;
+    samplerInfo.minLod = options.MinLod;
+    samplerInfo.maxLod = options.MaxLod;
 
-    vkDestroySampler(_gpu->_device, _sampler, nullptr);
+    VkSampler sampler;
+
+    if (vkCreateSampler(gpu->_device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create texture sampler!");
+
+    return sampler;
 }
 
 VkFilter Sampler::GetVkFilter(FilterMode filterMode)
@@ -62,4 +88,34 @@ VkFilter Sampler::GetVkFilter(FilterMode filterMode)
             throw std::runtime_error("Tried to get a VkFilter from an invalid filter mode!");
     }
 }
+
+VkSamplerMipmapMode Sampler::GetVkSamplerMipmapMode(MipmapMode mipmapMode)
+{
+    switch (mipmapMode)
+    {
+        case MipmapMode::Linear:
+            return VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        case MipmapMode::Nearest:
+            return VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        default:
+            throw std::runtime_error("Tried to get a VkSamplerMipmapMode from an invalid mipmap mode!");
+    }
+}
+
+VkSamplerAddressMode Sampler::GetVkSamplerAddressMode(AddressMode addressMode)
+{
+    switch (addressMode)
+    {
+        case AddressMode::Repeat:
+            return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        case AddressMode::MirroredRepeat:
+            return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+        case AddressMode::ClampToEdge:
+            return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        case AddressMode::ClampToBorder:
+            return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        default:
+            throw std::runtime_error("Tried to get a VkSamplerAddressMode from an invalid address mode!");
+    }
+}
 } // namespace GpuVk
\ No newline at end of file
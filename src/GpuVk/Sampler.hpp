@@ -2,23 +2,31 @@
 
 #include "FilterMode.hpp"
 #include "Image.hpp"
+#include "SamplerOptions.hpp"
 
 namespace GpuVk
 {
 class Sampler
 {
+    friend class Gpu;
     friend class Pipeline;
+    friend class Descriptors;
 
     public:
     Sampler() = default;
+    // Filters anisotropically at the GPU's maximum when minifying linearly, and allows every mip level of the image.
     Sampler(std::shared_ptr<Gpu> gpu, const Image& image, FilterMode minFilter = FilterMode::Linear,
         FilterMode magFilter = FilterMode::Linear);
+    Sampler(std::shared_ptr<Gpu> gpu, const SamplerOptions& options);
     Sampler(Sampler&& other);
     Sampler& operator=(Sampler&& other);
-    ~Sampler();
 
     private:
+    // Samplers are owned by the GPU's cache, which destroys them when it's cleaned up.
+    static VkSampler CreateVkSampler(std::shared_ptr<Gpu> gpu, const SamplerOptions& options);
     static VkFilter GetVkFilter(FilterMode filterMode);
+    static VkSamplerMipmapMode GetVkSamplerMipmapMode(MipmapMode mipmapMode);
+    static VkSamplerAddressMode GetVkSamplerAddressMode(AddressMode addressMode);
 
     std::shared_ptr<Gpu> _gpu;
 
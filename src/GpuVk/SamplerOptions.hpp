@@ -0,0 +1,45 @@
+#pragma once
+
+#include <optional>
+
+#include "CompareOp.hpp"
+#include "FilterMode.hpp"
+
+namespace GpuVk
+{
+enum class MipmapMode
+{
+    Linear,
+    Nearest
+};
+
+enum class AddressMode
+{
+    Repeat,
+    MirroredRepeat,
+    ClampToEdge,
+    ClampToBorder
+};
+
+// Samplers with the same options share one Vulkan sampler, since drivers only allow a limited number of them.
+struct SamplerOptions
+{
+    FilterMode MinFilter = FilterMode::Linear;
+    FilterMode MagFilter = FilterMode::Linear;
+    MipmapMode MipmapMode = MipmapMode::Linear;
+    AddressMode AddressModeU = AddressMode::Repeat;
+    AddressMode AddressModeV = AddressMode::Repeat;
+    AddressMode AddressModeW = AddressMode::Repeat;
+    // 1 disables anisotropic filtering, which only helps textures seen at an angle and costs bandwidth otherwise.
+    // Higher values are lowered to the GPU's maximum.
+    float MaxAnisotropy = 1.0f;
+    float MipLodBias = 0.0f;
+    float MinLod = 0.0f;
+    // Any value past the image's last mip level allows sampling all of them.
+    float MaxLod = 1000.0f;
+    // Compares sampled values against a reference instead of returning them, eg. for filtered shadow map lookups.
+    std::optional<CompareOp> CompareOp;
+
+    bool operator==(const SamplerOptions& other) const = default;
+};
+} // namespace GpuVk
\ No newline at end of file
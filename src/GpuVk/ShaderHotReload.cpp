@@ -0,0 +1,283 @@
+#include "ShaderHotReload.hpp"
+
+
+namespace GpuVk
+{
+ShaderHotReload::ShaderHotReload(std::shared_ptr<Gpu> gpu, std::chrono::milliseconds pollInterval)
+    : _gpu(gpu), _state(std::make_unique<WatchState>())
+{
+    _state->PollInterval = pollInterval;
+    _thread = std::thread(Poll, std::ref(*_state), _gpu->_device);
+}
+
+ShaderHotReload::ShaderHotReload(ShaderHotReload&& other)
+{
+    *this = std::move(other);
+}
+
+ShaderHotReload& ShaderHotReload::operator=(ShaderHotReload&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_state, other._state);
+    std::swap(_thread, other._thread);
+
+    return *this;
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+    if (!_gpu)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_state->Mutex);
+        _state->IsRunning = false;
+    }
+
+    _state->WakeUp.notify_one();
+    _thread.join();
+
+    // Pipelines that were rebuilt but never swapped in haven't been used by any frame.
+    for (auto& watched : _state->Watched)
+    {
+        if (watched.Rebuilt != VK_NULL_HANDLE)
+            vkDestroyPipeline(_gpu->_device, watched.Rebuilt, nullptr);
+    }
+}
+
+void ShaderHotReload::Watch(Pipeline& pipeline)
+{
+    WatchedPipeline watched{};
+    watched.Graphics = &pipeline;
+    watched.Options = pipeline._options;
+    watched.Target = pipeline._target;
+    watched.Layout = pipeline._pipelineLayout;
+    watched.Files = {pipeline._options.VertexShader};
+
+    if (!pipeline._options.FragmentShader.empty())
+        watched.Files.push_back(pipeline._options.FragmentShader);
+
+    AddWatched(std::move(watched));
+}
+
+void ShaderHotReload::Watch(ComputePipeline& pipeline)
+{
+    WatchedPipeline watched{};
+    watched.Compute = &pipeline;
+    watched.ComputeShader = pipeline._computeShader;
+    watched.Layout = pipeline._pipelineLayout;
+    watched.Files = {pipeline._computeShader};
+
+    AddWatched(std::move(watched));
+}
+
+void ShaderHotReload::Unwatch(const Pipeline& pipeline)
+{
+    RemoveWatched(&pipeline);
+}
+
+void ShaderHotReload::Unwatch(const ComputePipeline& pipeline)
+{
+    RemoveWatched(&pipeline);
+}
+
+void ShaderHotReload::Update()
+{
+    if (!_gpu)
+        return;
+
+    std::lock_guard<std::mutex> lock(_state->Mutex);
+
+    for (auto& watched : _state->Watched)
+    {
+        if (watched.Rebuilt == VK_NULL_HANDLE)
+            continue;
+
+        VkPipeline& current = watched.Graphics ? watched.Graphics->_pipeline : watched.Compute->_pipeline;
+
+        _gpu->DeferDestroy([device = _gpu->_device, pipeline = current] {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        });
+
+        current = watched.Rebuilt;
+        watched.Rebuilt = VK_NULL_HANDLE;
+    }
+}
+
+void ShaderHotReload::AddWatched(WatchedPipeline watched)
+{
+    if (!_gpu)
+        throw std::runtime_error("Tried to watch a pipeline without initializing shader hot reloading!");
+
+    UpdateWriteTimes(watched);
+    watched.HasChanged = false;
+
+    std::lock_guard<std::mutex> lock(_state->Mutex);
+    _state->Watched.push_back(std::move(watched));
+}
+
+std::string ShaderHotReload::GetLastError(const Pipeline& pipeline) const
+{
+    return GetWatchedError(&pipeline);
+}
+
+std::string ShaderHotReload::GetLastError(const ComputePipeline& pipeline) const
+{
+    return GetWatchedError(&pipeline);
+}
+
+std::string ShaderHotReload::GetWatchedError(const void* pipeline) const
+{
+    if (!_gpu)
+        return std::string();
+
+    std::lock_guard<std::mutex> lock(_state->Mutex);
+
+    for (const auto& watched : _state->Watched)
+    {
+        if (watched.Graphics == pipeline || watched.Compute == pipeline)
+            return watched.Error;
+    }
+
+    return std::string();
+}
+
+void ShaderHotReload::RemoveWatched(const void* pipeline)
+{
+    if (!_gpu)
+        return;
+
+    std::lock_guard<std::mutex> buildLock(_state->BuildMutex);
+    std::lock_guard<std::mutex> lock(_state->Mutex);
+
+    auto& watchedPipelines = _state->Watched;
+    for (auto it = watchedPipelines.begin(); it != watchedPipelines.end(); it++)
+    {
+        if (it->Graphics != pipeline && it->Compute != pipeline)
+            continue;
+
+        if (it->Rebuilt != VK_NULL_HANDLE)
+            vkDestroyPipeline(_gpu->_device, it->Rebuilt, nullptr);
+
+        watchedPipelines.erase(it);
+        return;
+    }
+}
+
+void ShaderHotReload::Poll(WatchState& state, VkDevice device)
+{
+    std::unique_lock<std::mutex> lock(state.Mutex);
+
+    while (true)
+    {
+        state.WakeUp.wait_for(lock, state.PollInterval, [&state] { return !state.IsRunning; });
+
+        if (!state.IsRunning)
+            return;
+
+        // Rebuild from copies of the watched state so that the main thread isn't blocked while pipelines compile.
+        std::vector<WatchedPipeline> toRebuild;
+        for (auto& watched : state.Watched)
+        {
+            // Changes are only acted on once the files have stopped changing for a poll, which avoids
+            // rebuilding from a file that is still being written.
+            if (UpdateWriteTimes(watched))
+                continue;
+
+            if (!watched.HasChanged)
+                continue;
+
+            watched.HasChanged = false;
+            toRebuild.push_back(watched);
+            toRebuild.back().Rebuilt = VK_NULL_HANDLE;
+        }
+
+        if (toRebuild.empty())
+            continue;
+
+        lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> buildLock(state.BuildMutex);
+
+            for (auto& watched : toRebuild)
+            {
+                try
+                {
+                    if (watched.Graphics)
+                    {
+                        watched.Rebuilt =
+                            Pipeline::Build(device, watched.Options, watched.Target, watched.Layout, VK_NULL_HANDLE);
+                    }
+                    else
+                    {
+                        watched.Rebuilt = ComputePipeline::Build(device, watched.ComputeShader, watched.Layout);
+                    }
+
+                    watched.Error.clear();
+                }
+                catch (const std::exception& exception)
+                {
+                    // Keep using the old pipeline, it will be rebuilt again the next time its shaders change.
+                    watched.Error = exception.what();
+                }
+            }
+
+            lock.lock();
+
+            for (auto& rebuilt : toRebuild)
+            {
+                for (auto& watched : state.Watched)
+                {
+                    if (watched.Graphics != rebuilt.Graphics || watched.Compute != rebuilt.Compute)
+                        continue;
+
+                    watched.Error = rebuilt.Error;
+
+                    if (rebuilt.Rebuilt == VK_NULL_HANDLE)
+                        break;
+
+                    // A newer rebuild replaces one that hasn't been swapped in yet.
+                    if (watched.Rebuilt != VK_NULL_HANDLE)
+                        vkDestroyPipeline(device, watched.Rebuilt, nullptr);
+
+                    watched.Rebuilt = rebuilt.Rebuilt;
+                    rebuilt.Rebuilt = VK_NULL_HANDLE;
+                    break;
+                }
+
+                if (rebuilt.Rebuilt != VK_NULL_HANDLE)
+                    vkDestroyPipeline(device, rebuilt.Rebuilt, nullptr);
+            }
+        }
+    }
+}
+
+bool ShaderHotReload::UpdateWriteTimes(WatchedPipeline& watched)
+{
+    bool didChange = false;
+    watched.WriteTimes.resize(watched.Files.size());
+
+    for (size_t i = 0; i < watched.Files.size(); i++)
+    {
+        std::error_code error;
+        auto writeTime = std::filesystem::last_write_time(watched.Files[i], error);
+
+        // The file may be briefly missing while an editor or compiler replaces it.
+        if (error)
+            continue;
+
+        if (writeTime != watched.WriteTimes[i])
+        {
+            watched.WriteTimes[i] = writeTime;
+            didChange = true;
+        }
+    }
+
+    if (didChange)
+        watched.HasChanged = true;
+
+    return didChange;
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ComputePipeline.hpp"
+#include "Gpu.hpp"
+#include "Pipeline.hpp"
+
+namespace GpuVk
+{
+// Watches the SPIR-V files used by pipelines and rebuilds those pipelines on a background thread when the files
+// change. Rebuilt pipelines are swapped in by Update, the pipelines they replace are destroyed once no frame in
+// flight can be using them. Watched pipelines shouldn't be moved, and should be unwatched before being destroyed
+// unless the ShaderHotReload is destroyed first.
+class ShaderHotReload
+{
+    public:
+    ShaderHotReload() = default;
+    ShaderHotReload(std::shared_ptr<Gpu> gpu, std::chrono::milliseconds pollInterval = std::chrono::milliseconds(250));
+    ShaderHotReload(ShaderHotReload&& other);
+    ShaderHotReload& operator=(ShaderHotReload&& other);
+    ~ShaderHotReload();
+
+    void Watch(Pipeline& pipeline);
+    void Watch(ComputePipeline& pipeline);
+    void Unwatch(const Pipeline& pipeline);
+    void Unwatch(const ComputePipeline& pipeline);
+
+    // Swaps in pipelines that have finished rebuilding, call this between frames, eg. in IRenderer::Update.
+    void Update();
+
+    // Why the last rebuild of a watched pipeline failed, empty if it succeeded or there hasn't been one yet.
+    std::string GetLastError(const Pipeline& pipeline) const;
+    std::string GetLastError(const ComputePipeline& pipeline) const;
+
+    private:
+    struct WatchedPipeline
+    {
+        Pipeline* Graphics = nullptr;
+        ComputePipeline* Compute = nullptr;
+
+        // Copies of everything needed to rebuild, so the background thread never touches the pipeline itself.
+        PipelineOptions Options;
+        Pipeline::RenderTarget Target;
+        std::string ComputeShader;
+        VkPipelineLayout Layout = VK_NULL_HANDLE;
+
+        std::vector<std::string> Files;
+        std::vector<std::filesystem::file_time_type> WriteTimes;
+        bool HasChanged = false;
+
+        VkPipeline Rebuilt = VK_NULL_HANDLE;
+        std::string Error;
+    };
+
+    // Kept on the heap so the background thread's reference to it survives the ShaderHotReload being moved.
+    struct WatchState
+    {
+        std::mutex Mutex;
+        // Held while rebuilding, so that a pipeline can't be unwatched and destroyed part way through its rebuild.
+        std::mutex BuildMutex;
+        std::condition_variable WakeUp;
+        bool IsRunning = true;
+        std::chrono::milliseconds PollInterval;
+        std::vector<WatchedPipeline> Watched;
+    };
+
+    void AddWatched(WatchedPipeline watched);
+    void RemoveWatched(const void* pipeline);
+    std::string GetWatchedError(const void* pipeline) const;
+
+    static void Poll(WatchState& state, VkDevice device);
+    static bool UpdateWriteTimes(WatchedPipeline& watched);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    std::unique_ptr<WatchState> _state;
+    std::thread _thread;
+};
+} // namespace GpuVk
\ No newline at end of file
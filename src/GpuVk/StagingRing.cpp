@@ -0,0 +1,69 @@
+#include "StagingRing.hpp"
+#include "Gpu.hpp"
+
+namespace GpuVk
+{
+StagingRing::StagingRing(std::shared_ptr<Gpu> gpu, VkDeviceSize byteSize)
+    : _gpu(gpu), _buffer(gpu, byteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true)
+{
+}
+
+StagingRing::StagingRing(StagingRing&& other)
+{
+    *this = std::move(other);
+}
+
+StagingRing& StagingRing::operator=(StagingRing&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_buffer, other._buffer);
+    std::swap(_inUse, other._inUse);
+    std::swap(_head, other._head);
+
+    return *this;
+}
+
+std::optional<StagingAllocation> StagingRing::Allocate(VkDeviceSize byteSize, VkDeviceSize alignment)
+{
+    if (!_gpu)
+        return std::nullopt;
+
+    ReleaseRetired();
+
+    if (_inUse.empty())
+        _head = 0;
+
+    VkDeviceSize capacity = _buffer.GetSize();
+    VkDeviceSize tail = _inUse.empty() ? capacity : _inUse.front().Start;
+    VkDeviceSize start = (_head + alignment - 1) / alignment * alignment;
+    bool isWrapped = !_inUse.empty() && _head <= tail;
+
+    // Before wrapping, the free space is from the head to the end, and then from the start to the tail.
+    if (!isWrapped && start + byteSize > capacity)
+    {
+        if (_inUse.empty() || byteSize > tail)
+            return std::nullopt;
+
+        start = 0;
+    }
+    else if (isWrapped && start + byteSize > tail)
+    {
+        return std::nullopt;
+    }
+
+    _head = start + byteSize;
+    _inUse.push_back(InUse{_gpu->_frameCount, start, _head});
+
+    return StagingAllocation{
+        _buffer._buffer, start, static_cast<uint8_t*>(_buffer._allocationInfo.pMappedData) + start};
+}
+
+void StagingRing::ReleaseRetired()
+{
+    // Allocations can be made before the current frame's fence is waited on, eg. in IRenderer::Update, so only
+    // frames older than the ones that fence could still be guarding are known to have finished.
+    while (!_inUse.empty() && _inUse.front().Frame + MaxFramesInFlight < _gpu->_frameCount)
+        _inUse.pop_front();
+}
+} // namespace GpuVk
\ No newline at end of file
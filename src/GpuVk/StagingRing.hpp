@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <memory>
+#include <optional>
+
+#include "Buffer.hpp"
+
+namespace GpuVk
+{
+class Gpu;
+
+// Part of the staging ring that the CPU can write into directly, to be copied from by commands of the current frame.
+struct StagingAllocation
+{
+    VkBuffer Buffer;
+    VkDeviceSize Offset;
+    uint8_t* Data;
+};
+
+// A persistently mapped buffer that uploads are sub-allocated from in order. Allocations are reused once the
+// frame that allocated them is no longer in flight, so nothing is written while the GPU could still read it.
+class StagingRing
+{
+    friend class Gpu;
+    friend class Image;
+
+    public:
+    StagingRing() = default;
+    StagingRing(std::shared_ptr<Gpu> gpu, VkDeviceSize byteSize = 64 * 1024 * 1024);
+    StagingRing(StagingRing&& other);
+    StagingRing& operator=(StagingRing&& other);
+
+    private:
+    // Returns nothing when there is no room, eg. for uploads larger than the ring, which need their own buffer.
+    std::optional<StagingAllocation> Allocate(VkDeviceSize byteSize, VkDeviceSize alignment = 16);
+    void ReleaseRetired();
+
+    struct InUse
+    {
+        uint64_t Frame;
+        VkDeviceSize Start;
+        VkDeviceSize End;
+    };
+
+    std::shared_ptr<Gpu> _gpu;
+
+    Buffer _buffer;
+    std::deque<InUse> _inUse;
+    VkDeviceSize _head = 0;
+};
+} // namespace GpuVk
\ No newline at end of file
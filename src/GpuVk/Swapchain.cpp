@@ -36,7 +36,7 @@ Swapchain::~Swapchain()
     Destroy();
 }
 
-void Swapchain::Create(int32_t windowWidth, int32_t windowHeight)
+void Swapchain::Create(int32_t windowWidth, int32_t windowHeight, VkSwapchainKHR oldSwapchain)
 {
     auto swapchainSupport = QuerySupport(_gpu->_physicalDevice, _gpu->_surface);
 
@@ -80,6 +80,8 @@ void Swapchain::Create(int32_t windowWidth, int32_t windowHeight)
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
+    // Lets the presentation engine hand the old swapchain's resources over instead of starting from scratch.
+    createInfo.oldSwapchain = oldSwapchain;
 
     if (vkCreateSwapchainKHR(_gpu->_device, &createInfo, nullptr, &_swapchain) != VK_SUCCESS)
         throw std::runtime_error("Failed to create swap chain!");
@@ -100,10 +102,13 @@ void Swapchain::UpdatePresentMode(PresentMode presentMode)
 
 void Swapchain::Resize(int32_t windowWidth, int32_t windowHeight)
 {
-    vkDeviceWaitIdle(_gpu->_device);
+    VkSwapchainKHR oldSwapchain = _swapchain;
 
-    Destroy();
-    Create(windowWidth, windowHeight);
+    Create(windowWidth, windowHeight, oldSwapchain);
+
+    // The old swapchain is retired by now, but frames that are still in flight may be presenting its images.
+    _gpu->DeferDestroy(
+        [device = _gpu->_device, oldSwapchain] { vkDestroySwapchainKHR(device, oldSwapchain, nullptr); });
 }
 
 SwapchainSupportDetails Swapchain::QuerySupport(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface)
@@ -28,6 +28,7 @@ class Swapchain
     friend class Gpu;
     friend class RenderEngine;
     friend class RenderPass;
+    friend class RenderGraph;
 
     public:
     void UpdatePresentMode(PresentMode presentMode);
@@ -39,7 +40,7 @@ class Swapchain
     Swapchain& operator=(Swapchain&& other);
     ~Swapchain();
 
-    void Create(int32_t windowWidth, int32_t windowHeight);
+    void Create(int32_t windowWidth, int32_t windowHeight, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
     void Destroy();
     void Resize(int32_t windowWidth, int32_t windowHeight);
 
@@ -57,7 +58,7 @@ class Swapchain
 
     std::shared_ptr<Gpu> _gpu;
 
-    VkSwapchainKHR _swapchain;
+    VkSwapchainKHR _swapchain = VK_NULL_HANDLE;
     PresentMode _preferredPresentMode;
     VkExtent2D _extent;
     VkFormat _imageFormat;
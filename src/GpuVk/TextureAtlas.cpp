@@ -0,0 +1,199 @@
+#include "TextureAtlas.hpp"
+#include "Buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace GpuVk
+{
+TextureAtlas::TextureAtlas(
+    std::shared_ptr<Gpu> gpu, const std::vector<std::string>& images, const TextureAtlasOptions& options)
+{
+    if (images.empty())
+        throw std::runtime_error("Tried to create a texture atlas without any images!");
+
+    uint32_t padding = options.Padding;
+    uint32_t mipmapLevelCount = 1;
+
+    if (options.EnableMipmaps && padding > 0)
+        mipmapLevelCount = static_cast<uint32_t>(std::floor(std::log2(padding))) + 1;
+
+    // Images start at multiples of the texels that a texel of the smallest level covers, so that no texel of any
+    // level mixes two images.
+    uint32_t alignment = 1u << (mipmapLevelCount - 1);
+
+    std::vector<std::vector<uint8_t>> pixels(images.size());
+    std::vector<int32_t> widths(images.size());
+    std::vector<int32_t> heights(images.size());
+
+    for (size_t i = 0; i < images.size(); i++)
+        pixels[i] = Image::DecodeImage(images[i], widths[i], heights[i]);
+
+    auto getCellWidth = [&](size_t i) { return (widths[i] + 2 * padding + alignment - 1) / alignment * alignment; };
+    auto getCellHeight = [&](size_t i) { return (heights[i] + 2 * padding + alignment - 1) / alignment * alignment; };
+
+    // Packing the tallest images first leaves a flatter skyline, which wastes less space.
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return getCellHeight(a) != getCellHeight(b) ? getCellHeight(a) > getCellHeight(b)
+                                                    : getCellWidth(a) > getCellWidth(b);
+    });
+
+    std::vector<std::vector<SkylineSegment>> skylines;
+    std::vector<Placement> placements(images.size());
+    uint32_t atlasWidth = 0;
+    uint32_t atlasHeight = 0;
+
+    for (size_t i : order)
+    {
+        uint32_t cellWidth = getCellWidth(i);
+        uint32_t cellHeight = getCellHeight(i);
+
+        if (cellWidth > options.PageWidth || cellHeight > options.PageHeight)
+            throw std::runtime_error(std::string("Tried to pack an image that's larger than an atlas page: ") +
+                images[i]);
+
+        Placement& placement = placements[i];
+        bool isPacked = false;
+
+        for (uint32_t page = 0; page < skylines.size() && !isPacked; page++)
+        {
+            placement.Page = page;
+            isPacked = TryPack(skylines[page], options.PageWidth, options.PageHeight, cellWidth, cellHeight,
+                placement.X, placement.Y);
+        }
+
+        if (!isPacked)
+        {
+            skylines.push_back({{0, 0, options.PageWidth}});
+            placement.Page = static_cast<uint32_t>(skylines.size() - 1);
+            TryPack(skylines.back(), options.PageWidth, options.PageHeight, cellWidth, cellHeight, placement.X,
+                placement.Y);
+        }
+
+        atlasWidth = std::max(atlasWidth, placement.X + cellWidth);
+        atlasHeight = std::max(atlasHeight, placement.Y + cellHeight);
+    }
+
+    uint32_t pageCount = static_cast<uint32_t>(skylines.size());
+    size_t pageByteSize = static_cast<size_t>(atlasWidth) * atlasHeight * 4;
+    std::vector<uint8_t> atlasPixels(pageByteSize * pageCount);
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        const Placement& placement = placements[i];
+        uint8_t* page = atlasPixels.data() + placement.Page * pageByteSize;
+
+        // The padding around each image repeats its closest edge texel.
+        for (uint32_t y = 0; y < getCellHeight(i); y++)
+        {
+            int32_t srcY = std::clamp(static_cast<int32_t>(y) - static_cast<int32_t>(padding), 0, heights[i] - 1);
+
+            for (uint32_t x = 0; x < getCellWidth(i); x++)
+            {
+                int32_t srcX = std::clamp(static_cast<int32_t>(x) - static_cast<int32_t>(padding), 0, widths[i] - 1);
+
+                std::memcpy(page + ((placement.Y + y) * atlasWidth + placement.X + x) * 4,
+                    pixels[i].data() + (srcY * widths[i] + srcX) * 4, 4);
+            }
+        }
+
+        _regions.push_back(AtlasRegion{placement.Page, static_cast<float>(placement.X + padding) / atlasWidth,
+            static_cast<float>(placement.Y + padding) / atlasHeight, static_cast<float>(widths[i]) / atlasWidth,
+            static_cast<float>(heights[i]) / atlasHeight});
+    }
+
+    mipmapLevelCount = std::min(mipmapLevelCount, Image::CalculateMipmapLevelCount(atlasWidth, atlasHeight));
+
+    Buffer stagingBuffer(gpu, atlasPixels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    stagingBuffer.SetData(atlasPixels.data());
+
+    // Always viewed as an array, so the same shaders work however many pages the images needed.
+    _image = Image(gpu, atlasWidth, atlasHeight, VK_FORMAT_R8G8B8A8_SRGB,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, mipmapLevelCount, pageCount, VK_SAMPLE_COUNT_1_BIT, true);
+
+    // Pages are stacked vertically in the staging buffer, like a texture array's source image.
+    _image.TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    _image.CopyFromBuffer(stagingBuffer, atlasWidth, atlasHeight * pageCount);
+
+    _image.GenerateMipmaps();
+}
+
+const AtlasRegion& TextureAtlas::GetRegion(size_t index) const
+{
+    return _regions[index];
+}
+
+const Image& TextureAtlas::GetImage() const
+{
+    return _image;
+}
+
+bool TextureAtlas::TryPack(std::vector<SkylineSegment>& skyline, uint32_t pageWidth, uint32_t pageHeight,
+    uint32_t width, uint32_t height, uint32_t& x, uint32_t& y)
+{
+    size_t bestIndex = skyline.size();
+    uint32_t bestBottom = pageHeight + 1;
+
+    // Find the position where the image's top edge would be the lowest, resting on the segments it spans.
+    for (size_t i = 0; i < skyline.size() && skyline[i].X + width <= pageWidth; i++)
+    {
+        uint32_t top = 0;
+        uint32_t remainingWidth = width;
+
+        for (size_t j = i; remainingWidth > 0; j++)
+        {
+            top = std::max(top, skyline[j].Y);
+            remainingWidth -= std::min(remainingWidth, skyline[j].Width);
+        }
+
+        if (top + height < bestBottom)
+        {
+            bestIndex = i;
+            bestBottom = top + height;
+            y = top;
+        }
+    }
+
+    if (bestBottom > pageHeight)
+        return false;
+
+    x = skyline[bestIndex].X;
+    uint32_t end = x + width;
+
+    // The segments under the image are replaced by its top edge, the last one may only be partly covered.
+    while (bestIndex < skyline.size() && skyline[bestIndex].X < end)
+    {
+        uint32_t segmentEnd = skyline[bestIndex].X + skyline[bestIndex].Width;
+
+        if (segmentEnd > end)
+        {
+            skyline[bestIndex].X = end;
+            skyline[bestIndex].Width = segmentEnd - end;
+            break;
+        }
+
+        skyline.erase(skyline.begin() + bestIndex);
+    }
+
+    skyline.insert(skyline.begin() + bestIndex, SkylineSegment{x, bestBottom, width});
+
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].Y == skyline[i + 1].Y)
+        {
+            skyline[i].Width += skyline[i + 1].Width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return true;
+}
+} // namespace GpuVk
\ No newline at end of file
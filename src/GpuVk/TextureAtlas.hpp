@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Image.hpp"
+#include "TextureAtlasOptions.hpp"
+
+namespace GpuVk
+{
+// Packs images of different sizes into one texture, so they can be drawn without switching descriptors. The texture
+// is an array of pages, sampled with a sampler2DArray and the region's layer.
+class TextureAtlas
+{
+    public:
+    TextureAtlas() = default;
+    TextureAtlas(
+        std::shared_ptr<Gpu> gpu, const std::vector<std::string>& images, const TextureAtlasOptions& options = {});
+
+    // Regions are in the same order as the images the atlas was created with.
+    const AtlasRegion& GetRegion(size_t index) const;
+    const Image& GetImage() const;
+
+    private:
+    struct Placement
+    {
+        uint32_t Page;
+        uint32_t X;
+        uint32_t Y;
+    };
+
+    // A bottom left skyline packer, each page keeps the top edge of what has been packed so far as segments.
+    struct SkylineSegment
+    {
+        uint32_t X;
+        uint32_t Y;
+        uint32_t Width;
+    };
+
+    static bool TryPack(std::vector<SkylineSegment>& skyline, uint32_t pageWidth, uint32_t pageHeight,
+        uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+
+    Image _image;
+    std::vector<AtlasRegion> _regions;
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace GpuVk
+{
+struct TextureAtlasOptions
+{
+    // The largest size of each page, pages are shrunk to fit what was packed into them.
+    uint32_t PageWidth = 2048;
+    uint32_t PageHeight = 2048;
+    // Texels around each image that repeat its edges, so that filtering doesn't bleed neighbouring images in. Mip
+    // levels are limited so that the smallest one still has a texel of padding, ie: 4 allows 3 levels.
+    uint32_t Padding = 4;
+    bool EnableMipmaps = false;
+};
+
+// Where an image was packed, in texture coordinates of the atlas, eg. for a sprite's texture position and size.
+struct AtlasRegion
+{
+    // The page of the atlas, which is always a texture array, even when everything fits on one page.
+    uint32_t Layer;
+    float U;
+    float V;
+    float Width;
+    float Height;
+};
+} // namespace GpuVk
\ No newline at end of file
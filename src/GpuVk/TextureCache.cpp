@@ -0,0 +1,329 @@
+#include "TextureCache.hpp"
+#include "BlockEncoder.hpp"
+#include "File.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace GpuVk
+{
+// Bumped whenever the baked contents change, so old cache files are never read.
+const uint32_t CacheVersion = 2;
+const char CacheMagic[8] = {'G', 'P', 'U', 'V', 'K', 'T', 'E', 'X'};
+
+// The header is followed by one region per mip level and layer, then the data, starting at a 16 byte boundary so
+// that it's aligned for any block size.
+struct CacheHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t Format;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t LayerCount;
+    uint32_t MipmapLevelCount;
+    uint32_t RegionCount;
+    uint32_t Padding;
+    uint64_t DataOffset;
+    uint64_t DataByteSize;
+};
+
+struct CacheRegion
+{
+    uint64_t Offset;
+    uint32_t MipLevel;
+    uint32_t Layer;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+TextureCache::TextureCache(std::shared_ptr<Gpu> gpu, const std::string& directory, bool enableCompression)
+    : _gpu(gpu), _directory(directory), _enableCompression(enableCompression && IsCompressionSupported(*gpu))
+{
+    std::filesystem::create_directories(_directory);
+}
+
+Image TextureCache::CreateTexture(const std::string& image, bool enableMipmaps)
+{
+    if (!_gpu)
+        throw std::runtime_error("Tried to create a texture without initializing the texture cache!");
+
+    // Hashing the source is much cheaper than decoding it, and catches images that were edited.
+    uint64_t hash = Hash(ReadFile(image), (enableMipmaps ? 1 : 0) | (_enableCompression ? 2 : 0));
+
+    char hashName[17];
+    std::snprintf(hashName, sizeof(hashName), "%016llx", static_cast<unsigned long long>(hash));
+    std::string cacheFile = (std::filesystem::path(_directory) / (std::string(hashName) + ".gputex")).string();
+
+    if (auto cachedImage = TryLoad(cacheFile))
+        return std::move(*cachedImage);
+
+    CompressedTexture texture = Bake(image, enableMipmaps, _enableCompression);
+
+    // A cache file that can't be written only means the image is baked again, so it doesn't stop the texture.
+    try
+    {
+        Write(cacheFile, texture);
+        _lastError.clear();
+    }
+    catch (const std::exception& e)
+    {
+        _lastError = e.what();
+    }
+
+    return Image::CreateFromRegions(_gpu, texture.Format, texture.Width, texture.Height, texture.MipmapLevelCount,
+        texture.LayerCount, texture.Data.data(), texture.Data.size(), texture.Regions);
+}
+
+std::optional<Image> TextureCache::TryLoad(const std::string& cacheFile) const
+{
+    if (!std::filesystem::exists(cacheFile))
+        return std::nullopt;
+
+    MappedFile file(cacheFile);
+    CacheHeader header;
+
+    if (file.GetSize() < sizeof(header))
+        return std::nullopt;
+
+    std::memcpy(&header, file.GetData(), sizeof(header));
+
+    // Anything unexpected, eg. a file from another version or one that was cut short, is baked again.
+    VkFormat format = static_cast<VkFormat>(header.Format);
+
+    if (std::memcmp(header.Magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.Version != CacheVersion ||
+        GetLevelByteSize(format, 1, 1) == 0 || header.Width == 0 || header.Height == 0 ||
+        header.MipmapLevelCount == 0 || header.LayerCount == 0 ||
+        header.RegionCount != static_cast<uint64_t>(header.MipmapLevelCount) * header.LayerCount ||
+        sizeof(header) + header.RegionCount * sizeof(CacheRegion) > header.DataOffset ||
+        header.DataOffset > file.GetSize() || header.DataByteSize > file.GetSize() - header.DataOffset)
+        return std::nullopt;
+
+    std::vector<VkBufferImageCopy> regions;
+    regions.reserve(header.RegionCount);
+
+    for (uint32_t i = 0; i < header.RegionCount; i++)
+    {
+        CacheRegion cacheRegion;
+        std::memcpy(&cacheRegion, file.GetData() + sizeof(header) + i * sizeof(cacheRegion), sizeof(cacheRegion));
+
+        // Regions that don't match their mip level's size or reach past the data would be copied out of bounds.
+        bool isValid = cacheRegion.MipLevel < header.MipmapLevelCount && cacheRegion.Layer < header.LayerCount &&
+                       cacheRegion.Width == std::max(header.Width >> cacheRegion.MipLevel, 1u) &&
+                       cacheRegion.Height == std::max(header.Height >> cacheRegion.MipLevel, 1u) &&
+                       cacheRegion.Offset <= header.DataByteSize &&
+                       GetLevelByteSize(format, cacheRegion.Width, cacheRegion.Height) <=
+                           header.DataByteSize - cacheRegion.Offset;
+
+        if (!isValid)
+            return std::nullopt;
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = cacheRegion.Offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = cacheRegion.MipLevel;
+        region.imageSubresource.baseArrayLayer = cacheRegion.Layer;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {cacheRegion.Width, cacheRegion.Height, 1};
+        regions.push_back(region);
+    }
+
+    // The mapped data is copied straight into the staging buffer, pages are only read from disk as it's copied.
+    return Image::CreateFromRegions(_gpu, format, header.Width, header.Height, header.MipmapLevelCount,
+        header.LayerCount, file.GetData() + header.DataOffset, header.DataByteSize, regions);
+}
+
+CompressedTexture TextureCache::Bake(const std::string& image, bool enableMipmaps, bool enableCompression)
+{
+    int32_t width, height;
+    std::vector<uint8_t> pixels = Image::DecodeImage(image, width, height);
+
+    CompressedTexture texture;
+    texture.Format = VK_FORMAT_R8G8B8A8_SRGB;
+
+    if (enableCompression)
+    {
+        // Averaging mip levels never makes an opaque image transparent, so the first level decides.
+        bool isOpaque = true;
+
+        for (size_t i = 3; i < pixels.size() && isOpaque; i += 4)
+            isOpaque = pixels[i] == 255;
+
+        texture.Format = isOpaque ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC3_SRGB_BLOCK;
+    }
+
+    texture.Width = width;
+    texture.Height = height;
+    texture.MipmapLevelCount = enableMipmaps ? Image::CalculateMipmapLevelCount(width, height) : 1;
+
+    float toLinear[256];
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        float value = i / 255.0f;
+        toLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    uint32_t levelWidth = width;
+    uint32_t levelHeight = height;
+
+    for (uint32_t level = 0; level < texture.MipmapLevelCount; level++)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset = texture.Data.size();
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {levelWidth, levelHeight, 1};
+        texture.Regions.push_back(region);
+
+        if (enableCompression)
+        {
+            std::vector<uint8_t> blocks = BlockEncoder::Encode(pixels.data(), levelWidth, levelHeight, texture.Format);
+            texture.Data.insert(texture.Data.end(), blocks.begin(), blocks.end());
+        }
+        else
+        {
+            texture.Data.insert(texture.Data.end(), pixels.begin(), pixels.end());
+        }
+
+        if (level + 1 == texture.MipmapLevelCount)
+            break;
+
+        uint32_t nextWidth = std::max(levelWidth / 2, 1u);
+        uint32_t nextHeight = std::max(levelHeight / 2, 1u);
+        std::vector<uint8_t> nextPixels(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+        // Each texel averages the 2x2 texels it covers, which are clamped to the edge of odd sized levels.
+        for (uint32_t y = 0; y < nextHeight; y++)
+        {
+            for (uint32_t x = 0; x < nextWidth; x++)
+            {
+                uint32_t x0 = std::min(x * 2, levelWidth - 1);
+                uint32_t x1 = std::min(x * 2 + 1, levelWidth - 1);
+                uint32_t y0 = std::min(y * 2, levelHeight - 1);
+                uint32_t y1 = std::min(y * 2 + 1, levelHeight - 1);
+
+                const uint8_t* texels[] = {&pixels[(y0 * levelWidth + x0) * 4], &pixels[(y0 * levelWidth + x1) * 4],
+                    &pixels[(y1 * levelWidth + x0) * 4], &pixels[(y1 * levelWidth + x1) * 4]};
+
+                uint8_t* texel = &nextPixels[(y * nextWidth + x) * 4];
+
+                for (uint32_t channel = 0; channel < 3; channel++)
+                {
+                    float linear = 0.0f;
+
+                    for (const uint8_t* source : texels)
+                        linear += toLinear[source[channel]] * 0.25f;
+
+                    float value = linear <= 0.0031308f ? linear * 12.92f
+                                                       : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+                    texel[channel] = static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+
+                // Alpha isn't sRGB encoded.
+                uint32_t alpha = texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3];
+                texel[3] = static_cast<uint8_t>((alpha + 2) / 4);
+            }
+        }
+
+        pixels = std::move(nextPixels);
+        levelWidth = nextWidth;
+        levelHeight = nextHeight;
+    }
+
+    return texture;
+}
+
+void TextureCache::Write(const std::string& cacheFile, const CompressedTexture& texture)
+{
+    CacheHeader header{};
+    std::memcpy(header.Magic, CacheMagic, sizeof(CacheMagic));
+    header.Version = CacheVersion;
+    header.Format = texture.Format;
+    header.Width = texture.Width;
+    header.Height = texture.Height;
+    header.LayerCount = texture.LayerCount;
+    header.MipmapLevelCount = texture.MipmapLevelCount;
+    header.RegionCount = static_cast<uint32_t>(texture.Regions.size());
+    header.DataOffset = (sizeof(header) + texture.Regions.size() * sizeof(CacheRegion) + 15) / 16 * 16;
+    header.DataByteSize = texture.Data.size();
+
+    // Written to a temporary file first, so a run that stops part way never leaves a broken cache file behind.
+    std::string temporaryFile = cacheFile + ".tmp";
+
+    {
+        std::ofstream file(temporaryFile, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open texture cache file " + temporaryFile + "!");
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (const auto& region : texture.Regions)
+        {
+            CacheRegion cacheRegion{region.bufferOffset, region.imageSubresource.mipLevel,
+                region.imageSubresource.baseArrayLayer, region.imageExtent.width, region.imageExtent.height};
+            file.write(reinterpret_cast<const char*>(&cacheRegion), sizeof(cacheRegion));
+        }
+
+        std::vector<char> padding(header.DataOffset - static_cast<uint64_t>(file.tellp()));
+        file.write(padding.data(), padding.size());
+        file.write(reinterpret_cast<const char*>(texture.Data.data()), texture.Data.size());
+
+        if (!file)
+            throw std::runtime_error("Failed to write texture cache file " + temporaryFile + "!");
+    }
+
+    std::filesystem::rename(temporaryFile, cacheFile);
+}
+
+const std::string& TextureCache::GetLastError() const
+{
+    return _lastError;
+}
+
+uint64_t TextureCache::Hash(const std::vector<char>& data, uint64_t seed)
+{
+    // 64 bit FNV-1a, the seed keeps textures baked with and without mipmaps apart.
+    uint64_t hash = 14695981039346656037ull ^ seed;
+
+    for (char byte : data)
+    {
+        hash ^= static_cast<uint8_t>(byte);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+bool TextureCache::IsCompressionSupported(const Gpu& gpu)
+{
+    // BC formats are supported together, but checking both that are baked doesn't rely on it.
+    for (VkFormat format : {VK_FORMAT_BC1_RGBA_SRGB_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK})
+    {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(gpu._physicalDevice, format, &formatProperties);
+
+        if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+            return false;
+    }
+
+    return true;
+}
+
+uint64_t TextureCache::GetLevelByteSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    if (format == VK_FORMAT_R8G8B8A8_SRGB)
+        return static_cast<uint64_t>(width) * height * 4;
+
+    if (format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK)
+        return BlockEncoder::GetByteSize(format, width, height);
+
+    return 0;
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "CompressedTexture.hpp"
+#include "Gpu.hpp"
+#include "Image.hpp"
+
+namespace GpuVk
+{
+// Bakes textures into GPU ready files the first time they're loaded, with their whole mip chain, keyed by a hash
+// of the source image's contents. Later runs map the baked file and upload it directly, skipping decoding and mip
+// generation. Edited images get a new hash, so they're baked again. Textures are block compressed when the GPU
+// supports it, to BC1 when they're opaque or BC3 otherwise, which takes a quarter or half of the memory.
+class TextureCache
+{
+    friend class TextureStreamer;
+
+    public:
+    TextureCache() = default;
+    TextureCache(std::shared_ptr<Gpu> gpu, const std::string& directory, bool enableCompression = true);
+
+    Image CreateTexture(const std::string& image, bool enableMipmaps);
+    // Why the last baked texture couldn't be written to the cache, eg. a read only directory, empty if it was.
+    // The texture is still created, it's only baked again the next time.
+    const std::string& GetLastError() const;
+
+    private:
+    std::optional<Image> TryLoad(const std::string& cacheFile) const;
+
+    // Mip levels are averaged in linear space like blits of sRGB images, so baked textures match the ones from
+    // Image::CreateTexture.
+    static CompressedTexture Bake(const std::string& image, bool enableMipmaps, bool enableCompression);
+    static void Write(const std::string& cacheFile, const CompressedTexture& texture);
+    static uint64_t Hash(const std::vector<char>& data, uint64_t seed);
+    static bool IsCompressionSupported(const Gpu& gpu);
+    // Zero for formats that aren't baked.
+    static uint64_t GetLevelByteSize(VkFormat format, uint32_t width, uint32_t height);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    std::string _directory;
+    bool _enableCompression = false;
+    std::string _lastError;
+};
+} // namespace GpuVk
\ No newline at end of file
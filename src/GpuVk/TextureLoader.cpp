@@ -0,0 +1,226 @@
+#include "TextureLoader.hpp"
+#include "Buffer.hpp"
+
+#include <algorithm>
+
+namespace GpuVk
+{
+bool AsyncTexture::IsReady() const
+{
+    return _isReady;
+}
+
+bool AsyncTexture::HasFailed() const
+{
+    return _hasFailed;
+}
+
+const std::string& AsyncTexture::GetError() const
+{
+    return _error;
+}
+
+const Image& AsyncTexture::GetImage() const
+{
+    return _isReady ? _image : *_placeholder;
+}
+
+TextureLoader::TextureLoader(std::shared_ptr<Gpu> gpu, uint32_t threadCount, uint64_t uploadBudget)
+    : _gpu(gpu), _state(std::make_unique<LoadState>()), _uploadBudget(uploadBudget)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    CreatePlaceholder();
+
+    for (uint32_t i = 0; i < threadCount; i++)
+        _threads.push_back(std::thread(Decode, std::ref(*_state)));
+}
+
+TextureLoader::TextureLoader(TextureLoader&& other)
+{
+    *this = std::move(other);
+}
+
+TextureLoader& TextureLoader::operator=(TextureLoader&& other)
+{
+    std::swap(_gpu, other._gpu);
+
+    std::swap(_state, other._state);
+    std::swap(_threads, other._threads);
+    std::swap(_placeholder, other._placeholder);
+    std::swap(_uploadBudget, other._uploadBudget);
+
+    return *this;
+}
+
+TextureLoader::~TextureLoader()
+{
+    if (!_gpu)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_state->Mutex);
+        _state->IsRunning = false;
+    }
+
+    _state->WakeUp.notify_all();
+
+    for (auto& thread : _threads)
+        thread.join();
+}
+
+std::shared_ptr<AsyncTexture> TextureLoader::Load(const std::string& image, bool enableMipmaps, ReadyCallback onReady)
+{
+    if (!_gpu)
+        throw std::runtime_error("Tried to load a texture without initializing the texture loader!");
+
+    auto texture = std::make_shared<AsyncTexture>();
+    texture->_placeholder = _placeholder;
+
+    Job job{};
+    job.Path = image;
+    job.EnableMipmaps = enableMipmaps;
+    job.Texture = texture;
+    job.OnReady = std::move(onReady);
+
+    {
+        std::lock_guard<std::mutex> lock(_state->Mutex);
+        _state->Pending.push_back(std::move(job));
+    }
+
+    _state->WakeUp.notify_one();
+
+    return texture;
+}
+
+void TextureLoader::Update()
+{
+    if (!_gpu)
+        return;
+
+    std::vector<Job> jobs;
+    uint64_t uploadSize = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_state->Mutex);
+
+        while (!_state->Decoded.empty() && (jobs.empty() || uploadSize < _uploadBudget))
+        {
+            uploadSize += _state->Decoded.front().Pixels.size();
+            jobs.push_back(std::move(_state->Decoded.front()));
+            _state->Decoded.pop_front();
+        }
+    }
+
+    if (jobs.empty())
+        return;
+
+    // Every texture is recorded into one command buffer, which is submitted without waiting for it. Frames are
+    // submitted to the same queue afterwards, so they only sample the textures after the upload.
+    VkCommandBuffer commandBuffer = _gpu->Commands.BeginSingleTime();
+    auto stagingBuffers = std::make_shared<std::vector<Buffer>>();
+
+    for (auto& job : jobs)
+    {
+        if (!job.Error.empty())
+        {
+            job.Texture->_hasFailed = true;
+            job.Texture->_error = std::move(job.Error);
+            continue;
+        }
+
+        uint32_t mipmapLevels = job.EnableMipmaps ? Image::CalculateMipmapLevelCount(job.Width, job.Height) : 1;
+
+        Buffer stagingBuffer(_gpu, job.Pixels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+        stagingBuffer.SetData(job.Pixels.data());
+
+        Image textureImage(_gpu, job.Width, job.Height, VK_FORMAT_R8G8B8A8_SRGB,
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_IMAGE_ASPECT_COLOR_BIT, mipmapLevels);
+
+        textureImage.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        textureImage.RecordCopyFromBuffer(commandBuffer, stagingBuffer);
+        textureImage.RecordGenerateMipmaps(commandBuffer);
+
+        job.Texture->_image = std::move(textureImage);
+        stagingBuffers->push_back(std::move(stagingBuffer));
+    }
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(_gpu->_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit texture uploads!");
+
+    // The next frames' fences only signal once the upload, which was submitted before them, has finished too.
+    _gpu->DeferDestroy([device = _gpu->_device, commandPool = _gpu->Commands._commandPool, commandBuffer,
+                           stagingBuffers] {
+        stagingBuffers->clear();
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    });
+
+    for (auto& job : jobs)
+    {
+        if (job.Texture->_hasFailed)
+            continue;
+
+        job.Texture->_isReady = true;
+
+        if (job.OnReady)
+            job.OnReady(job.Texture->_image);
+    }
+}
+
+void TextureLoader::CreatePlaceholder()
+{
+    // A single grey pixel, so that a texture that isn't ready yet doesn't stand out too much.
+    const uint8_t pixel[] = {128, 128, 128, 255};
+
+    Buffer stagingBuffer(_gpu, sizeof(pixel), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    stagingBuffer.SetData(pixel);
+
+    _placeholder = std::make_shared<Image>(Image(_gpu, 1, 1, VK_FORMAT_R8G8B8A8_SRGB,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT));
+
+    _placeholder->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    _placeholder->CopyFromBuffer(stagingBuffer);
+    _placeholder->TransitionImageLayout(
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void TextureLoader::Decode(LoadState& state)
+{
+    std::unique_lock<std::mutex> lock(state.Mutex);
+
+    while (true)
+    {
+        state.WakeUp.wait(lock, [&state] { return !state.IsRunning || !state.Pending.empty(); });
+
+        if (!state.IsRunning)
+            return;
+
+        Job job = std::move(state.Pending.front());
+        state.Pending.pop_front();
+
+        lock.unlock();
+
+        try
+        {
+            job.Pixels = Image::DecodeImage(job.Path, job.Width, job.Height);
+        }
+        catch (const std::exception& exception)
+        {
+            job.Error = exception.what();
+        }
+
+        lock.lock();
+        state.Decoded.push_back(std::move(job));
+    }
+}
+} // namespace GpuVk
\ No newline at end of file
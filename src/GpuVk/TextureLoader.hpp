@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Gpu.hpp"
+#include "Image.hpp"
+
+namespace GpuVk
+{
+// A texture that is loaded by a TextureLoader. Its image is the loader's placeholder until it's ready.
+class AsyncTexture
+{
+    friend class TextureLoader;
+
+    public:
+    bool IsReady() const;
+    // Textures that failed to load keep using the placeholder.
+    bool HasFailed() const;
+    // Why the texture failed to load, empty unless it has.
+    const std::string& GetError() const;
+    const Image& GetImage() const;
+
+    private:
+    std::shared_ptr<Image> _placeholder;
+    Image _image;
+    bool _isReady = false;
+    bool _hasFailed = false;
+    std::string _error;
+};
+
+// Decodes textures on a pool of worker threads, then uploads the decoded ones together in a single submission
+// from Update. Load time scales with the number of cores instead of being bound by a single one.
+class TextureLoader
+{
+    public:
+    using ReadyCallback = std::function<void(const Image&)>;
+
+    TextureLoader() = default;
+    // A thread count of 0 uses one thread per core, leaving one for the main thread. Each Update uploads at
+    // least one texture, and then more until the upload budget is reached.
+    TextureLoader(std::shared_ptr<Gpu> gpu, uint32_t threadCount = 0, uint64_t uploadBudget = 64 * 1024 * 1024);
+    TextureLoader(TextureLoader&& other);
+    TextureLoader& operator=(TextureLoader&& other);
+    ~TextureLoader();
+
+    // Returns immediately, the texture can be used with its placeholder image until it's ready. The callback runs
+    // from Update once the texture is ready, eg. to update the descriptors that use it.
+    std::shared_ptr<AsyncTexture> Load(
+        const std::string& image, bool enableMipmaps, ReadyCallback onReady = ReadyCallback());
+
+    // Uploads textures that have finished decoding, call this between frames, eg. in IRenderer::Update.
+    void Update();
+
+    private:
+    struct Job
+    {
+        std::string Path;
+        bool EnableMipmaps;
+        std::shared_ptr<AsyncTexture> Texture;
+        ReadyCallback OnReady;
+
+        std::vector<uint8_t> Pixels;
+        int32_t Width = 0;
+        int32_t Height = 0;
+        std::string Error;
+    };
+
+    // Kept on the heap so the worker threads' reference to it survives the TextureLoader being moved.
+    struct LoadState
+    {
+        std::mutex Mutex;
+        std::condition_variable WakeUp;
+        bool IsRunning = true;
+        std::deque<Job> Pending;
+        std::deque<Job> Decoded;
+    };
+
+    void CreatePlaceholder();
+
+    static void Decode(LoadState& state);
+
+    std::shared_ptr<Gpu> _gpu;
+
+    std::unique_ptr<LoadState> _state;
+    std::vector<std::thread> _threads;
+    std::shared_ptr<Image> _placeholder;
+    uint64_t _uploadBudget = 0;
+};
+} // namespace GpuVk
\ No newline at end of file
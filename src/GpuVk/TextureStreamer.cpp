@@ -0,0 +1,255 @@
+#include "TextureStreamer.hpp"
+#include "Buffer.hpp"
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+namespace GpuVk
+{
+void StreamedTexture::RequestLevel(uint32_t level)
+{
+    _requestedLevel = level;
+}
+
+const Image& StreamedTexture::GetImage() const
+{
+    return _image;
+}
+
+uint32_t StreamedTexture::GetResidentLevel() const
+{
+    return _residentLevel;
+}
+
+uint64_t StreamedTexture::GetByteSize(uint32_t firstLevel) const
+{
+    uint64_t byteSize = 0;
+
+    for (uint32_t level = firstLevel; level < _levelByteSizes.size(); level++)
+        byteSize += _levelByteSizes[level];
+
+    return byteSize;
+}
+
+TextureStreamer::TextureStreamer(
+    std::shared_ptr<Gpu> gpu, uint64_t budget, uint32_t initialSize, uint64_t uploadBudget)
+    : _gpu(gpu), _budget(budget), _initialSize(initialSize), _uploadBudget(uploadBudget)
+{
+}
+
+std::shared_ptr<StreamedTexture> TextureStreamer::Load(const std::string& image, ChangedCallback onChanged)
+{
+    if (!_gpu)
+        throw std::runtime_error("Tried to load a texture without initializing the texture streamer!");
+
+    auto texture = std::make_shared<StreamedTexture>();
+    std::string extension = std::filesystem::path(image).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    // Every level is kept on the CPU, so that any of them can be streamed in later. Other images are block
+    // compressed like baked textures, so that more of them fit in the budget.
+    texture->_source = extension == ".ktx2" || extension == ".dds"
+                           ? CompressedTexture::Read(image)
+                           : TextureCache::Bake(image, true, TextureCache::IsCompressionSupported(*_gpu));
+    texture->_onChanged = std::move(onChanged);
+
+    const CompressedTexture& source = texture->_source;
+    texture->_levelByteSizes.resize(source.MipmapLevelCount);
+
+    for (size_t i = 0; i < source.Regions.size(); i++)
+    {
+        size_t end = i + 1 < source.Regions.size() ? source.Regions[i + 1].bufferOffset : source.Data.size();
+        texture->_levelByteSizes[source.Regions[i].imageSubresource.mipLevel] += end - source.Regions[i].bufferOffset;
+    }
+
+    uint32_t level = 0;
+
+    while (level + 1 < source.MipmapLevelCount &&
+           std::max(source.Width >> level, source.Height >> level) > _initialSize)
+        level++;
+
+    texture->_initialLevel = level;
+    texture->_requestedLevel = level;
+    texture->_residentLevel = level;
+
+    // The initial levels are small, so they're uploaded right away.
+    std::vector<Buffer> stagingBuffers;
+    VkCommandBuffer commandBuffer = _gpu->Commands.BeginSingleTime();
+    texture->_image = RecordUpload(commandBuffer, *texture, level, stagingBuffers);
+    _gpu->Commands.EndSingleTime(commandBuffer);
+
+    _textures.push_back(texture);
+
+    return texture;
+}
+
+void TextureStreamer::Update()
+{
+    if (!_gpu)
+        return;
+
+    std::vector<Change> changes = FindChanges();
+
+    if (changes.empty())
+        return;
+
+    // Every change is recorded into one command buffer, which is submitted without waiting for it. Frames are
+    // submitted to the same queue afterwards, so they only sample the new images after the upload.
+    VkCommandBuffer commandBuffer = _gpu->Commands.BeginSingleTime();
+    auto stagingBuffers = std::make_shared<std::vector<Buffer>>();
+    auto replacedImages = std::make_shared<std::vector<Image>>();
+    uint64_t uploadSize = 0;
+    size_t changeCount = 0;
+
+    for (; changeCount < changes.size() && (changeCount == 0 || uploadSize < _uploadBudget); changeCount++)
+    {
+        StreamedTexture& texture = *changes[changeCount].Texture;
+        uint32_t level = changes[changeCount].Level;
+
+        replacedImages->push_back(RecordUpload(commandBuffer, texture, level, *stagingBuffers));
+        std::swap(texture._image, replacedImages->back());
+        texture._residentLevel = level;
+        uploadSize += texture.GetByteSize(level);
+    }
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(_gpu->_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit texture streaming uploads!");
+
+    // Frames in flight may still sample the replaced images.
+    _gpu->DeferDestroy([device = _gpu->_device, commandPool = _gpu->Commands._commandPool, commandBuffer,
+                           stagingBuffers, replacedImages] {
+        stagingBuffers->clear();
+        replacedImages->clear();
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    });
+
+    for (size_t i = 0; i < changeCount; i++)
+    {
+        if (changes[i].Texture->_onChanged)
+            changes[i].Texture->_onChanged(changes[i].Texture->_image);
+    }
+}
+
+uint64_t TextureStreamer::GetResidentByteSize() const
+{
+    uint64_t byteSize = 0;
+
+    for (const auto& weakTexture : _textures)
+    {
+        if (auto texture = weakTexture.lock())
+            byteSize += texture->GetByteSize(texture->_residentLevel);
+    }
+
+    return byteSize;
+}
+
+std::vector<TextureStreamer::Change> TextureStreamer::FindChanges()
+{
+    std::erase_if(_textures, [](const auto& texture) { return texture.expired(); });
+
+    std::vector<Change> targets;
+    uint64_t byteSize = 0;
+
+    for (const auto& weakTexture : _textures)
+    {
+        auto texture = weakTexture.lock();
+        uint32_t level = std::min(texture->_requestedLevel, texture->_initialLevel);
+
+        targets.push_back({texture, level});
+        byteSize += texture->GetByteSize(level);
+    }
+
+    // Over the budget, the finest level that takes the most memory is dropped until everything fits, but the
+    // initial levels are always kept.
+    while (byteSize > _budget)
+    {
+        Change* largest = nullptr;
+
+        for (auto& target : targets)
+        {
+            if (target.Level < target.Texture->_initialLevel &&
+                (!largest || target.Texture->_levelByteSizes[target.Level] >
+                                 largest->Texture->_levelByteSizes[largest->Level]))
+                largest = &target;
+        }
+
+        if (!largest)
+            break;
+
+        byteSize -= largest->Texture->_levelByteSizes[largest->Level];
+        largest->Level++;
+    }
+
+    std::erase_if(targets, [](const Change& target) { return target.Level == target.Texture->_residentLevel; });
+
+    // Textures that drop levels free memory, so they go first, then the smallest uploads so that more fit.
+    std::stable_sort(targets.begin(), targets.end(), [](const Change& a, const Change& b) {
+        bool isDroppingA = a.Level > a.Texture->_residentLevel;
+        bool isDroppingB = b.Level > b.Texture->_residentLevel;
+
+        return isDroppingA != isDroppingB ? isDroppingA
+                                          : a.Texture->GetByteSize(a.Level) < b.Texture->GetByteSize(b.Level);
+    });
+
+    return targets;
+}
+
+Image TextureStreamer::RecordUpload(VkCommandBuffer commandBuffer, const StreamedTexture& texture, uint32_t level,
+    std::vector<Buffer>& stagingBuffers) const
+{
+    const CompressedTexture& source = texture._source;
+
+    Buffer stagingBuffer(_gpu, texture.GetByteSize(level), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    auto stagingData = static_cast<uint8_t*>(stagingBuffer._allocationInfo.pMappedData);
+
+    std::vector<VkBufferImageCopy> regions;
+    VkDeviceSize offset = 0;
+
+    // The image only has the levels from the given one, which become its levels from 0.
+    for (size_t i = 0; i < source.Regions.size(); i++)
+    {
+        if (source.Regions[i].imageSubresource.mipLevel < level)
+            continue;
+
+        size_t end = i + 1 < source.Regions.size() ? source.Regions[i + 1].bufferOffset : source.Data.size();
+        size_t byteSize = end - source.Regions[i].bufferOffset;
+
+        std::memcpy(stagingData + offset, source.Data.data() + source.Regions[i].bufferOffset, byteSize);
+
+        VkBufferImageCopy region = source.Regions[i];
+        region.bufferOffset = offset;
+        region.imageSubresource.mipLevel -= level;
+        regions.push_back(region);
+
+        offset += byteSize;
+    }
+
+    Image image(_gpu, std::max(source.Width >> level, 1u), std::max(source.Height >> level, 1u), source.Format,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+        source.MipmapLevelCount - level, source.LayerCount);
+
+    image.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer._buffer, image._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data());
+
+    image.RecordBarrier(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT);
+
+    stagingBuffers.push_back(std::move(stagingBuffer));
+
+    return image;
+}
+} // namespace GpuVk
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CompressedTexture.hpp"
+#include "Gpu.hpp"
+#include "Image.hpp"
+
+namespace GpuVk
+{
+// A texture that only keeps its mip levels from the resident one down on the GPU, the finer ones are streamed in
+// by a TextureStreamer when they're requested and the budget allows it.
+class StreamedTexture
+{
+    friend class TextureStreamer;
+
+    public:
+    // The finest mip level that is needed, eg. from the texture's size on screen, where 0 is the full resolution.
+    void RequestLevel(uint32_t level);
+    // Only contains the resident levels, so its size is that of the resident level.
+    const Image& GetImage() const;
+    uint32_t GetResidentLevel() const;
+
+    private:
+    uint64_t GetByteSize(uint32_t firstLevel) const;
+
+    CompressedTexture _source;
+    std::vector<uint64_t> _levelByteSizes;
+    Image _image;
+    std::function<void(const Image&)> _onChanged;
+    uint32_t _residentLevel = 0;
+    uint32_t _requestedLevel = 0;
+    // Coarser levels than this one are always resident.
+    uint32_t _initialLevel = 0;
+};
+
+// Keeps the finest mip levels that textures request on the GPU, as long as they fit in a budget. When they don't,
+// textures drop their finest levels, largest first, and stream them back in once there is room again.
+class TextureStreamer
+{
+    public:
+    using ChangedCallback = std::function<void(const Image&)>;
+
+    TextureStreamer() = default;
+    // Textures start with the levels that are at most the initial size. Each Update uploads at least one texture,
+    // and then more until the upload budget is reached.
+    TextureStreamer(std::shared_ptr<Gpu> gpu, uint64_t budget, uint32_t initialSize = 64,
+        uint64_t uploadBudget = 16 * 1024 * 1024);
+
+    // Loads a KTX2 or DDS file with its own mip levels, or bakes the levels of other images. The callback runs
+    // whenever the texture's image is replaced, eg. to update the descriptors that use it.
+    std::shared_ptr<StreamedTexture> Load(const std::string& image, ChangedCallback onChanged = ChangedCallback());
+
+    // Moves textures towards their requested levels, call this between frames, eg. in IRenderer::Update.
+    void Update();
+
+    uint64_t GetResidentByteSize() const;
+
+    private:
+    struct Change
+    {
+        std::shared_ptr<StreamedTexture> Texture;
+        uint32_t Level;
+    };
+
+    std::vector<Change> FindChanges();
+    Image RecordUpload(VkCommandBuffer commandBuffer, const StreamedTexture& texture, uint32_t level,
+        std::vector<Buffer>& stagingBuffers) const;
+
+    std::shared_ptr<Gpu> _gpu;
+
+    std::vector<std::weak_ptr<StreamedTexture>> _textures;
+    uint64_t _budget = 0;
+    uint32_t _initialSize = 0;
+    uint64_t _uploadBudget = 0;
+};
+} // namespace GpuVk
\ No newline at end of file
@@ -11,6 +11,7 @@ namespace GpuVk
 template <typename T> class UniformBuffer
 {
     friend class Pipeline;
+    friend class Descriptors;
 
     public:
     UniformBuffer() = default;